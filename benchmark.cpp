@@ -0,0 +1,390 @@
+/**
+ * @file benchmark.cpp
+ * @brief Benchmarks for the bigint class.
+ *
+ * Measures decimal conversion of very large numbers (string to bigint and bigint to string)
+ * and reports how it scales with the number of threads, the throughput of parsing many
+ * short fields as in CSV ingest, the throughput of printing through an ostream, sorting
+ * large arrays of bigints, dot products with and without fused multiply-add, and products of
+ * modular powers computed one by one and with simultaneous multi-exponentiation, the
+ * segmented prime sieve, and products of operands of very different lengths.
+ *
+ * Usage: ./benchmark [digits]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "bigint.hpp"
+#include "bigint_sort.hpp"
+#include "modular.hpp"
+#include "prime_sieve.hpp"
+
+/**
+ * @brief Returns the time in seconds taken by the best of a few runs of a function.
+ *
+ * @param run The function to time.
+ * @return The fastest run time in seconds.
+ */
+template <typename Function>
+double bestTime(const Function &run)
+{
+    double best = 0;
+    for (int attempt = 0; attempt < 3; attempt++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        run();
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (attempt == 0 || elapsed.count() < best)
+        {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+/**
+ * @brief Times parsing and printing of a number with the given digit count for 1, 2, 4, ... threads.
+ *
+ * @param digitCount Number of decimal digits of the test number.
+ */
+void benchmarkConversionScaling(size_t digitCount)
+{
+    std::string text(digitCount, '0');
+    uint64_t state = 88172645463325252ULL;
+    for (char &c : text)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        c = static_cast<char>('0' + state % 10);
+    }
+    text[0] = '7';
+
+    std::cout << "Decimal conversion, " << digitCount << " digits\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "parse (s)" << std::setw(10) << "speedup"
+              << std::setw(14) << "print (s)" << std::setw(10) << "speedup" << "\n";
+
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    double parseBase = 0;
+    double printBase = 0;
+    for (unsigned threads = 1;; threads *= 2)
+    {
+        threads = std::min(threads, hardware);
+        bigint::set_max_threads(threads);
+
+        bigint value;
+        double parse = bestTime([&]()
+                                { value = bigint(text); });
+        std::string printed;
+        double print = bestTime([&]()
+                                { printed = value.to_string(); });
+        if (printed != text)
+        {
+            std::cerr << "Round trip mismatch with " << threads << " threads" << std::endl;
+            std::exit(1);
+        }
+        if (threads == 1)
+        {
+            parseBase = parse;
+            printBase = print;
+        }
+        std::cout << std::setw(8) << threads << std::setw(14) << parse << std::setw(10) << parseBase / parse
+                  << std::setw(14) << print << std::setw(10) << printBase / print << "\n";
+        if (threads == hardware)
+        {
+            break;
+        }
+    }
+    bigint::set_max_threads(0);
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Times parsing of many short decimal fields with the non-throwing parser.
+ *
+ * @param fieldCount Number of fields to parse.
+ */
+void benchmarkFieldParsing(size_t fieldCount)
+{
+    std::vector<std::string> fields(fieldCount);
+    size_t bytes = 0;
+    uint64_t state = 2463534242ULL;
+    for (std::string &field : fields)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        field = std::to_string(state) + std::to_string(state >> 20);
+        bytes += field.size();
+    }
+
+    bigint value;
+    size_t failures = 0;
+    double seconds = bestTime([&]()
+                              {
+        for (const std::string &field : fields)
+        {
+            failures += bigint::parse(field, value) != std::string::npos;
+        } });
+    std::cout << "Field parsing, " << fieldCount << " fields of ~" << bytes / fieldCount << " digits\n";
+    std::cout << "  " << seconds << " s, " << bytes / seconds / 1e6 << " MB/s";
+    if (failures != 0)
+    {
+        std::cout << " (" << failures << " failures)";
+    }
+    std::cout << "\n"
+              << std::endl;
+}
+
+/**
+ * @brief Times printing a large number to an output stream with operator<<.
+ *
+ * @param digitCount Number of decimal digits of the test number.
+ */
+void benchmarkStreamOutput(size_t digitCount)
+{
+    std::string text(digitCount, '0');
+    for (size_t i = 0; i < digitCount; i++)
+    {
+        text[i] = static_cast<char>('1' + (i * 13) % 9);
+    }
+    bigint value(text);
+
+    bigint::set_max_threads(1);
+    std::ostringstream os;
+    double seconds = bestTime([&]()
+                              {
+        os.str("");
+        os << value; });
+    bigint::set_max_threads(0);
+    std::cout << "Stream output (single thread), " << digitCount << " digits\n";
+    std::cout << "  " << seconds << " s, " << digitCount / seconds / 1e9 << " GB/s\n"
+              << std::endl;
+}
+
+/**
+ * @brief Compares std::sort with sort_bigints and sort_bigints_parallel.
+ *
+ * @param count Number of bigints to sort.
+ */
+void benchmarkSort(size_t count)
+{
+    std::vector<bigint> values;
+    values.reserve(count);
+    uint64_t state = 88172645463325252ULL;
+    for (size_t i = 0; i < count; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        std::string text = (state & 1) ? "-" : "";
+        text += std::to_string(state >> 1) + std::to_string(state % 1000003);
+        values.push_back(bigint(text.substr(0, 2 + state % 40)));
+    }
+
+    std::vector<bigint> work;
+    double standard = bestTime([&]()
+                               { work = values; std::sort(work.begin(), work.end()); });
+    double radix = bestTime([&]()
+                            { work = values; sort_bigints(work); });
+    double parallel = bestTime([&]()
+                               { work = values; sort_bigints_parallel(work); });
+    std::cout << "Sorting " << count << " bigints (including copying the input)\n";
+    std::cout << "  std::sort             " << standard << " s\n";
+    std::cout << "  sort_bigints          " << radix << " s\n";
+    std::cout << "  sort_bigints_parallel " << parallel << " s\n"
+              << std::endl;
+}
+
+/**
+ * @brief Compares a dot product written as acc += a * b with one using addmul.
+ *
+ * @param length Number of terms.
+ * @param digitCount Digits of every factor.
+ */
+void benchmarkDotProduct(size_t length, size_t digitCount)
+{
+    std::vector<bigint> left;
+    std::vector<bigint> right;
+    uint64_t state = 2463534242ULL;
+    for (size_t i = 0; i < 2 * length; i++)
+    {
+        std::string text;
+        while (text.size() < digitCount)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            text += std::to_string(state);
+        }
+        (i % 2 == 0 ? left : right).push_back(bigint(text.substr(0, digitCount)));
+    }
+
+    bigint separate;
+    bigint fused;
+    double separateTime = bestTime([&]()
+                                   {
+        separate = bigint();
+        for (size_t i = 0; i < length; i++)
+        {
+            separate += left[i] * right[i];
+        } });
+    double fusedTime = bestTime([&]()
+                                {
+        fused = bigint();
+        for (size_t i = 0; i < length; i++)
+        {
+            fused.addmul(left[i], right[i]);
+        } });
+    std::cout << "Dot product of " << length << " pairs of " << digitCount << "-digit numbers\n";
+    std::cout << "  acc += a * b       " << separateTime << " s\n";
+    std::cout << "  acc.addmul(a, b)   " << fusedTime << " s" << (fused == separate ? "" : " (MISMATCH)") << "\n"
+              << std::endl;
+}
+
+/**
+ * @brief Times a product of modular powers, one powmod per base against multi_powmod.
+ *
+ * @param count Number of bases.
+ * @param digitCount Digit count of the modulus, bases and exponents.
+ */
+void benchmarkMultiPowmod(size_t count, size_t digitCount)
+{
+    uint64_t state = 88172645463325252ULL;
+    auto randomNumber = [&]()
+    {
+        std::string text;
+        while (text.size() < digitCount)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            text += std::to_string(state);
+        }
+        return bigint(text.substr(0, digitCount));
+    };
+    bigint modulus = randomNumber() * bigint(10) + bigint(1);
+    std::vector<bigint> bases;
+    std::vector<bigint> exps;
+    for (size_t i = 0; i < count; i++)
+    {
+        bases.push_back(randomNumber());
+        exps.push_back(randomNumber());
+    }
+
+    montgomery reducer(modulus);
+    bigint separate;
+    bigint simultaneous;
+    double separateTime = bestTime([&]()
+                                   {
+        separate = bigint(1);
+        for (size_t i = 0; i < count; i++)
+        {
+            separate = separate * powmod(reducer, bases[i], exps[i]) % modulus;
+        } });
+    double singleTime = bestTime([&]()
+                                 { simultaneous = multi_powmod(reducer, bases, exps, 1); });
+    double threadedTime = bestTime([&]()
+                                   { simultaneous = multi_powmod(reducer, bases, exps); });
+    std::cout << "Product of " << count << " powers modulo a " << digitCount + 1 << "-digit number\n";
+    std::cout << "  powmod per base           " << separateTime << " s\n";
+    std::cout << "  multi_powmod, 1 thread    " << singleTime << " s\n";
+    std::cout << "  multi_powmod, " << bigint::max_threads() << " threads   " << threadedTime << " s"
+              << (simultaneous == separate ? "" : " (MISMATCH)") << "\n"
+              << std::endl;
+}
+
+/**
+ * @brief Times counting the primes up to a bound for 1, 2, 4, ... threads.
+ *
+ * @param limit Upper bound of the sieve.
+ */
+void benchmarkPrimeSieve(uint64_t limit)
+{
+    std::cout << "Counting primes up to " << limit << "\n";
+    std::cout << std::setw(8) << "threads" << std::setw(14) << "time (s)" << std::setw(10) << "speedup" << std::setw(14) << "primes" << "\n";
+    unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+    double base = 0;
+    for (unsigned threads = 1;; threads *= 2)
+    {
+        threads = std::min(threads, hardware);
+        uint64_t count = 0;
+        double time = bestTime([&]()
+                               { count = prime_sieve(limit).count(threads); });
+        if (threads == 1)
+        {
+            base = time;
+        }
+        std::cout << std::setw(8) << threads << std::setw(14) << time << std::setw(10) << base / time << std::setw(14) << count << "\n";
+        if (threads == hardware)
+        {
+            break;
+        }
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Times products of a fixed-size operand by operands of growing length ratio.
+ *
+ * @param digitCount Digit count of the shorter operand.
+ */
+void benchmarkUnbalanced(size_t digitCount)
+{
+    uint64_t state = 1181783497276652981ULL;
+    auto randomNumber = [&](size_t length)
+    {
+        std::string text;
+        while (text.size() < length)
+        {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            text += std::to_string(state);
+        }
+        text[0] = '9';
+        return bigint(text.substr(0, length));
+    };
+    bigint small = randomNumber(digitCount);
+    std::cout << "Unbalanced multiplication by a " << digitCount << "-digit number\n";
+    std::cout << std::setw(10) << "ratio" << std::setw(14) << "time (s)" << std::setw(14) << "per digit (ns)" << "\n";
+    for (size_t ratio : {1, 2, 3, 4, 8, 100})
+    {
+        bigint large = randomNumber(ratio * digitCount + digitCount / 2);
+        bigint product;
+        double time = bestTime([&]()
+                               { product = large * small; });
+        std::cout << std::setw(10) << (ratio * digitCount + digitCount / 2) / static_cast<double>(digitCount) << std::setw(14) << time
+                  << std::setw(14) << time * 1e9 / static_cast<double>(large.digit_count()) << "\n";
+    }
+    std::cout << std::endl;
+}
+
+/**
+ * @brief Runs all benchmarks.
+ *
+ * @param argc Argument count.
+ * @param argv Arguments, the optional first one is the digit count for conversion benchmarks.
+ * @return Returns 0 on success.
+ */
+int main(int argc, char *argv[])
+{
+    size_t digitCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000000;
+    std::cout << std::fixed << std::setprecision(4);
+    benchmarkConversionScaling(digitCount);
+    benchmarkFieldParsing(1000000);
+    benchmarkStreamOutput(digitCount);
+    benchmarkSort(1000000);
+    benchmarkDotProduct(1000, 200);
+    benchmarkMultiPowmod(4, 100);
+    benchmarkMultiPowmod(256, 100);
+    benchmarkPrimeSieve(1000000000);
+    benchmarkUnbalanced(2000);
+    return 0;
+}
@@ -11,11 +11,110 @@
  * @date 2024-12-15
  */
 
+#pragma once
+
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <string>
+#include <thread>
 #include <vector>
 #include <algorithm>
 #include <stdexcept>
+#include <utility>
+#include "ntt.hpp"
+
+class bigint;
+
+/**
+ * @brief The bigint operations reported to observers.
+ */
+enum class bigint_op : uint8_t
+{
+    add,
+    subtract,
+    multiply,
+    divide,
+    modulo
+};
+
+/**
+ * @brief Number of values of bigint_op.
+ */
+constexpr size_t bigint_op_count = 5;
+
+/**
+ * @brief Returns a short lowercase name for an operation, for reports and exports.
+ *
+ * @param op The operation.
+ * @return The name of the operation.
+ */
+inline const char *bigint_op_name(bigint_op op)
+{
+    switch (op)
+    {
+    case bigint_op::add:
+        return "add";
+    case bigint_op::subtract:
+        return "subtract";
+    case bigint_op::multiply:
+        return "multiply";
+    case bigint_op::divide:
+        return "divide";
+    case bigint_op::modulo:
+        return "modulo";
+    }
+    return "unknown";
+}
+
+/**
+ * @class bigint_observer
+ * @brief Interface for code that wants to see every bigint operation, e.g. tracing or profiling.
+ *
+ * Observers are registered with bigint::add_observer. Only top-level operations are reported:
+ * operations that a bigint operator performs internally are not. The callbacks may run on
+ * several threads at once.
+ */
+class bigint_observer
+{
+public:
+    virtual ~bigint_observer() = default;
+
+    /**
+     * @brief Called before an operation runs.
+     *
+     * @param op The operation.
+     * @param lhs The left operand.
+     * @param rhs The right operand, or nullptr for unary operations.
+     */
+    virtual void before(bigint_op op, const bigint &lhs, const bigint *rhs)
+    {
+        (void)op;
+        (void)lhs;
+        (void)rhs;
+    }
+
+    /**
+     * @brief Called after an operation finished.
+     *
+     * @param op The operation.
+     * @param lhsDigits Number of digits of the left operand.
+     * @param rhsDigits Number of digits of the right operand, 0 for unary operations.
+     * @param nanoseconds Time the operation took.
+     */
+    virtual void after(bigint_op op, size_t lhsDigits, size_t rhsDigits, uint64_t nanoseconds)
+    {
+        (void)op;
+        (void)lhsDigits;
+        (void)rhsDigits;
+        (void)nanoseconds;
+    }
+};
 
 /**
  * @class bigint
@@ -29,24 +128,1263 @@ private:
     std::vector<uint8_t> digits; // Store digits in reverse order
     bool is_negative;            // Whether the number is negative
 
+    friend class bigint_array;
+    friend struct modular_kernels;
+    friend class prepared_multiplier;
+
+    /**
+     * @brief Removes leading zeros from the digits.
+     *
+     * This function is used to preventing case happen like 0001.
+     */
+    void removeLeadingZeros()
+    {
+        while (digits.size() > 1 && digits.back() == 0)
+        {
+            digits.pop_back();
+        }
+        if (digits.size() == 1 && digits[0] == 0)
+        {
+            is_negative = false; // Zero is not negative
+        }
+    }
+
+    /**
+     * @brief Number of digits below which a conversion task is not split any further.
+     */
+    static constexpr size_t conversionGrain = size_t(1) << 16;
+
+    /**
+     * @brief Runs task over [begin, end) by recursive halving, running the halves in parallel.
+     *
+     * Each level hands the upper half to a new thread and keeps the lower half, until the range
+     * is no larger than grain or the thread allowance is used up.
+     *
+     * @param begin First index of the range.
+     * @param end One past the last index of the range.
+     * @param grain Smallest range worth splitting.
+     * @param threads Number of threads this range may use.
+     * @param task Callable taking (begin, end) of a sub-range.
+     */
+    template <typename Task>
+    static void parallelRange(size_t begin, size_t end, size_t grain, unsigned threads, const Task &task)
+    {
+        if (threads <= 1 || end - begin <= grain)
+        {
+            task(begin, end);
+            return;
+        }
+        size_t mid = begin + (end - begin) / 2;
+        unsigned upperThreads = threads / 2;
+        std::thread upper([&]()
+                          { parallelRange(mid, end, grain, upperThreads, task); });
+        parallelRange(begin, mid, grain, threads - upperThreads, task);
+        upper.join();
+    }
+
+    /**
+     * @brief Holds the thread limit shared by all parallel algorithms.
+     */
+    static std::atomic<unsigned> &threadLimit()
+    {
+        static std::atomic<unsigned> limit{0};
+        return limit;
+    }
+
+    /**
+     * @brief Returns a mask with the high bit set in every byte of word that is not an ASCII digit.
+     *
+     * Every byte is tested on its own (no carries cross byte boundaries), so the lowest marked
+     * byte is exactly the first invalid character.
+     */
+    static uint64_t nonDigitMask(uint64_t word)
+    {
+        const uint64_t high = 0x8080808080808080ULL;
+        uint64_t below = ~((word | high) - 0x3030303030303030ULL) & high; // (c & 0x7f) < '0'
+        uint64_t above = ((word & ~high) + 0x4646464646464646ULL) & high; // (c & 0x7f) > '9'
+        return below | above | (word & high);                            // or not ASCII at all
+    }
+
+    /**
+     * @brief Converts ASCII digits into digit values in reverse order.
+     *
+     * On little-endian targets 16 characters are handled per step with SWAR: two 8-byte words are
+     * validated with nonDigitMask, mapped to values with a mask and byte-reversed into out.
+     *
+     * @param text The characters, most significant first.
+     * @param count The number of characters.
+     * @param out Receives count digit values, least significant first.
+     * @return The offset in text of the first non-digit, or count if there is none.
+     */
+    static size_t reverseDigits(const char *text, size_t count, uint8_t *out)
+    {
+        size_t firstInvalid = count;
+        size_t i = 0;
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        const uint64_t low = 0x0F0F0F0F0F0F0F0FULL;
+        // walk text backwards so that out is written forwards; later hits are earlier in text
+        for (; i + 16 <= count; i += 16)
+        {
+            uint64_t words[2];
+            std::memcpy(words, text + count - i - 16, 16);
+            uint64_t bad0 = nonDigitMask(words[0]);
+            uint64_t bad1 = nonDigitMask(words[1]);
+            if ((bad0 | bad1) != 0)
+            {
+                size_t offset = bad0 != 0 ? __builtin_ctzll(bad0) / 8 : 8 + __builtin_ctzll(bad1) / 8;
+                firstInvalid = count - i - 16 + offset;
+            }
+            uint64_t values[2] = {__builtin_bswap64(words[1] & low), __builtin_bswap64(words[0] & low)};
+            std::memcpy(out + i, values, 16);
+        }
+        for (; i + 8 <= count; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, text + count - i - 8, 8);
+            uint64_t bad = nonDigitMask(word);
+            if (bad != 0)
+            {
+                firstInvalid = count - i - 8 + __builtin_ctzll(bad) / 8;
+            }
+            uint64_t value = __builtin_bswap64(word & low);
+            std::memcpy(out + i, &value, 8);
+        }
+#endif
+        for (; i < count; i++)
+        {
+            char c = text[count - 1 - i];
+            if (!std::isdigit(static_cast<unsigned char>(c)))
+            {
+                firstInvalid = count - 1 - i;
+            }
+            out[i] = static_cast<uint8_t>(c - '0');
+        }
+        return firstInvalid;
+    }
+
+    /**
+     * @brief Converts digit values in reverse order into ASCII characters.
+     *
+     * The mirror image of reverseDigits: on little-endian targets 16 digits are loaded as two
+     * 8-byte words, byte-reversed, turned into characters with one OR and stored together.
+     *
+     * @param in The digit values, least significant first.
+     * @param count The number of digits.
+     * @param text Receives count characters, most significant first.
+     */
+    static void formatDigits(const uint8_t *in, size_t count, char *text)
+    {
+        size_t i = 0;
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+        const uint64_t zeros = 0x3030303030303030ULL;
+        for (; i + 16 <= count; i += 16)
+        {
+            uint64_t words[2];
+            std::memcpy(words, in + i, 16);
+            uint64_t chars[2] = {__builtin_bswap64(words[1]) | zeros, __builtin_bswap64(words[0]) | zeros};
+            std::memcpy(text + count - i - 16, chars, 16);
+        }
+        for (; i + 8 <= count; i += 8)
+        {
+            uint64_t word;
+            std::memcpy(&word, in + i, 8);
+            uint64_t chars = __builtin_bswap64(word) | zeros;
+            std::memcpy(text + count - i - 8, &chars, 8);
+        }
+#endif
+        for (; i < count; i++)
+        {
+            text[count - 1 - i] = static_cast<char>('0' + in[i]);
+        }
+    }
+
+    /**
+     * @brief Converts a string of digits into digit values in reverse order, in parallel for long strings.
+     *
+     * @param text The characters, most significant first.
+     * @param count The number of characters.
+     * @param out Receives count digit values, least significant first.
+     * @return The offset in text of the first non-digit, or count if there is none.
+     */
+    static size_t convertDigits(const char *text, size_t count, uint8_t *out)
+    {
+        std::atomic<size_t> firstInvalid{count};
+        parallelRange(0, count, conversionGrain, max_threads(), [&](size_t begin, size_t end)
+                      {
+            // output digits [begin, end) come from characters [count - end, count - begin)
+            size_t offset = count - end;
+            size_t found = reverseDigits(text + offset, end - begin, out + begin);
+            if (found != end - begin)
+            {
+                size_t position = offset + found;
+                size_t current = firstInvalid.load(std::memory_order_relaxed);
+                while (position < current && !firstInvalid.compare_exchange_weak(current, position, std::memory_order_relaxed))
+                {
+                }
+            } });
+        return firstInvalid.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Converts the magnitude to a power-of-two base.
+     *
+     * The decimal digits are divided by 2^24 repeatedly; every remainder gives 24 bits worth of
+     * output digits at once.
+     *
+     * @param base The target base, one of 2, 8 and 16.
+     * @return The digit values in the target base, least significant first.
+     */
+    std::vector<uint8_t> toRadix(unsigned base) const
+    {
+        const unsigned bits = base == 16 ? 4 : base == 8 ? 3 : 1;
+        const uint64_t mask = (uint64_t(1) << 24) - 1;
+        std::vector<uint8_t> quotient(digits.rbegin(), digits.rend()); // most significant first
+        std::vector<uint8_t> result;
+        size_t start = 0;
+        while (start < quotient.size())
+        {
+            uint64_t remainder = 0;
+            for (size_t i = start; i < quotient.size(); i++)
+            {
+                remainder = remainder * 10 + quotient[i];
+                quotient[i] = static_cast<uint8_t>(remainder >> 24);
+                remainder &= mask;
+            }
+            while (start < quotient.size() && quotient[start] == 0)
+            {
+                start++;
+            }
+            for (unsigned k = 0; k < 24 / bits; k++)
+            {
+                result.push_back(static_cast<uint8_t>(remainder & (base - 1)));
+                remainder >>= bits;
+            }
+        }
+        while (result.size() > 1 && result.back() == 0)
+        {
+            result.pop_back();
+        }
+        return result;
+    }
+
+    /**
+     * @brief The registered observers. A fixed set of slots keeps the check on every operation to one load.
+     */
+    struct observerRegistry
+    {
+        static constexpr size_t capacity = 4;
+        std::atomic<bigint_observer *> slots[capacity] = {};
+        std::atomic<unsigned> count{0};
+    };
+
+    static observerRegistry &observers()
+    {
+        static observerRegistry registry;
+        return registry;
+    }
+
+    /**
+     * @brief Reports the enclosing operation to the observers, if any are registered.
+     *
+     * Tracks the nesting depth per thread, so that only the outermost operation is reported.
+     */
+    class operationScope
+    {
+    private:
+        bigint_op op;
+        size_t lhsDigits = 0;
+        size_t rhsDigits = 0;
+        bool counted = false;  // Whether this scope incremented the nesting depth
+        bool reported = false; // Whether this scope is the outermost one and reports
+        std::chrono::steady_clock::time_point start;
+
+        static unsigned &depth()
+        {
+            thread_local unsigned value = 0;
+            return value;
+        }
+
+    public:
+        operationScope(bigint_op operation, const bigint &lhs, const bigint *rhs) : op(operation)
+        {
+            observerRegistry &registry = observers();
+            if (registry.count.load(std::memory_order_acquire) == 0)
+            {
+                return;
+            }
+            counted = true;
+            if (depth()++ != 0)
+            {
+                return;
+            }
+            reported = true;
+            lhsDigits = lhs.digits.size();
+            rhsDigits = rhs != nullptr ? rhs->digits.size() : 0;
+            for (std::atomic<bigint_observer *> &slot : registry.slots)
+            {
+                if (bigint_observer *observer = slot.load(std::memory_order_acquire))
+                {
+                    observer->before(op, lhs, rhs);
+                }
+            }
+            start = std::chrono::steady_clock::now();
+        }
+
+        ~operationScope()
+        {
+            if (!counted)
+            {
+                return;
+            }
+            depth()--;
+            if (!reported)
+            {
+                return;
+            }
+            uint64_t nanoseconds = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+            for (std::atomic<bigint_observer *> &slot : observers().slots)
+            {
+                if (bigint_observer *observer = slot.load(std::memory_order_acquire))
+                {
+                    observer->after(op, lhsDigits, rhsDigits, nanoseconds);
+                }
+            }
+        }
+
+        operationScope(const operationScope &) = delete;
+        operationScope &operator=(const operationScope &) = delete;
+    };
+
+    /**
+     * @brief Compares the magnitudes of two bigints.
+     *
+     * Digits are stored least significant first, so the little-endian 64-bit word of the top
+     * eight digits compares like the digits themselves: one word comparison settles most pairs.
+     *
+     * @param other The bigint to compare with.
+     * @return Negative, zero or positive as |*this| is smaller, equal or larger than |other|.
+     */
+    int compareMagnitude(const bigint &other) const
+    {
+        if (digits.size() != other.digits.size())
+        {
+            return digits.size() < other.digits.size() ? -1 : 1;
+        }
+        size_t i = digits.size();
+        for (; i >= 8; i -= 8)
+        {
+            uint64_t a;
+            uint64_t b;
+            std::memcpy(&a, digits.data() + i - 8, 8);
+            std::memcpy(&b, other.digits.data() + i - 8, 8);
+            if (a != b)
+            {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                // fall through to the digit loop below for this block
+                break;
+#else
+                return a < b ? -1 : 1;
+#endif
+            }
+        }
+        for (; i > 0; i--)
+        {
+            if (digits[i - 1] != other.digits[i - 1])
+            {
+                return digits[i - 1] < other.digits[i - 1] ? -1 : 1;
+            }
+        }
+        return 0;
+    }
+
+    /**
+     * @brief Adds or subtracts the product of two digit ranges to this bigint, in place.
+     *
+     * Every row of partial products is accumulated straight into the digits of *this with a
+     * running carry (or borrow), so the product is never materialized. If subtracting leaves a
+     * borrow out of the top digit, the result went negative: the digits then hold the ten's
+     * complement of its magnitude, which is undone at the end and the sign flipped.
+     *
+     * @param a Digits of the first factor, least significant first.
+     * @param aCount Number of digits of a.
+     * @param b Digits of the second factor, least significant first.
+     * @param bCount Number of digits of b.
+     * @param termNegative Whether the term a * b is added with a negative sign.
+     */
+    void mulAccumulate(const uint8_t *a, size_t aCount, const uint8_t *b, size_t bCount, bool termNegative)
+    {
+        bool zeroAccumulator = digits.size() == 1 && digits[0] == 0;
+        if (zeroAccumulator)
+        {
+            is_negative = termNegative;
+        }
+        bool subtract = termNegative != is_negative;
+        // room for the whole product, so that a final borrow can only mean a negative result
+        digits.resize(std::max(digits.size(), aCount + bCount) + (subtract ? 0 : 1), 0);
+        size_t size = digits.size();
+        uint8_t *acc = digits.data();
+
+        int topBorrow = 0;
+        for (size_t i = 0; i < aCount; i++)
+        {
+            int factor = a[i];
+            if (factor == 0)
+            {
+                continue;
+            }
+            if (!subtract)
+            {
+                int carry = 0;
+                for (size_t j = 0; j < bCount; j++)
+                {
+                    int t = acc[i + j] + factor * b[j] + carry; // at most 9 + 81 + 9
+                    carry = t / 10;
+                    acc[i + j] = static_cast<uint8_t>(t - carry * 10);
+                }
+                for (size_t k = i + bCount; carry != 0; k++)
+                {
+                    int t = acc[k] + carry;
+                    carry = t / 10;
+                    acc[k] = static_cast<uint8_t>(t - carry * 10);
+                }
+            }
+            else
+            {
+                int borrow = 0;
+                for (size_t j = 0; j < bCount; j++)
+                {
+                    int t = acc[i + j] - factor * b[j] - borrow; // at least -90
+                    borrow = t < 0 ? (9 - t) / 10 : 0;
+                    acc[i + j] = static_cast<uint8_t>(t + borrow * 10);
+                }
+                for (size_t k = i + bCount; borrow != 0; k++)
+                {
+                    if (k == size)
+                    {
+                        topBorrow += borrow;
+                        break;
+                    }
+                    int t = acc[k] - borrow;
+                    borrow = t < 0 ? 1 : 0;
+                    acc[k] = static_cast<uint8_t>(t + borrow * 10);
+                }
+            }
+        }
+
+        if (topBorrow != 0)
+        {
+            // digits hold 10^size - |result|: take the ten's complement
+            int borrow = 0;
+            for (size_t k = 0; k < size; k++)
+            {
+                int t = -acc[k] - borrow;
+                borrow = t < 0 ? 1 : 0;
+                acc[k] = static_cast<uint8_t>(t + borrow * 10);
+            }
+            is_negative = !is_negative;
+        }
+        removeLeadingZeros();
+    }
+
+    /**
+     * @brief Returns whether the bigint is zero.
+     */
+    bool isZero() const
+    {
+        return digits.size() == 1 && digits[0] == 0;
+    }
+
+    /**
+     * @brief Divides the magnitudes of two bigints with schoolbook long division.
+     *
+     * Each quotient digit is estimated from the leading 17 digits of the divisor and of the running
+     * remainder, the estimate times the divisor is subtracted in place, and the rare off-by-one is
+     * corrected afterwards.
+     *
+     * @param divisor The divisor, not zero.
+     * @param quotient Receives |*this| / |divisor|.
+     * @param remainder Receives |*this| % |divisor|.
+     */
+    void divideMagnitude(const bigint &divisor, bigint &quotient, bigint &remainder) const
+    {
+        quotient = bigint();
+        remainder = bigint();
+        if (compareMagnitude(divisor) < 0)
+        {
+            remainder.digits = digits;
+            return;
+        }
+        bigint magnitude = divisor;
+        magnitude.is_negative = false;
+        const std::vector<uint8_t> &v = magnitude.digits;
+        size_t m = v.size();
+        size_t k = std::min<size_t>(m, 17);
+        uint64_t top = 0;
+        for (size_t j = 0; j < k; j++)
+        {
+            top = top * 10 + v[m - 1 - j];
+        }
+
+        quotient.digits.assign(digits.size(), 0);
+        for (size_t i = digits.size(); i > 0; i--)
+        {
+            // bring down the next digit: remainder = remainder * 10 + digit
+            if (remainder.isZero())
+            {
+                remainder.digits[0] = digits[i - 1];
+            }
+            else
+            {
+                remainder.digits.insert(remainder.digits.begin(), digits[i - 1]);
+            }
+            if (remainder.digits.size() < m)
+            {
+                continue;
+            }
+            // the remainder is below 10 * divisor, so it has m or m + 1 digits
+            size_t size = remainder.digits.size();
+            uint64_t head = 0;
+            for (size_t j = 0; j < k + (size - m); j++)
+            {
+                head = head * 10 + remainder.digits[size - 1 - j];
+            }
+            uint8_t q = static_cast<uint8_t>(std::min<uint64_t>(9, head / top));
+            if (q != 0)
+            {
+                remainder.mulAccumulate(v.data(), m, &q, 1, true);
+            }
+            while (remainder.is_negative)
+            {
+                remainder = remainder + magnitude;
+                q--;
+            }
+            while (remainder.compareMagnitude(magnitude) >= 0)
+            {
+                remainder = remainder - magnitude;
+                q++;
+            }
+            quotient.digits[i - 1] = q;
+        }
+        quotient.removeLeadingZeros();
+    }
+
+    /**
+     * @brief Operand size in digits from which products use Karatsuba instead of schoolbook.
+     */
+    static constexpr size_t karatsubaThreshold = 64;
+
+    /**
+     * @brief Adds a digit array into another in place; a carry out of dst is dropped.
+     *
+     * @param dst The digits to add to, dstCount of them.
+     * @param src The digits to add, srcCount of them.
+     */
+    static void addDigits(uint8_t *dst, size_t dstCount, const uint8_t *src, size_t srcCount)
+    {
+        int carry = 0;
+        size_t i = 0;
+        for (; i < std::min(srcCount, dstCount); i++)
+        {
+            int t = dst[i] + src[i] + carry;
+            carry = t >= 10 ? 1 : 0;
+            dst[i] = static_cast<uint8_t>(t - carry * 10);
+        }
+        for (; carry != 0 && i < dstCount; i++)
+        {
+            int t = dst[i] + carry;
+            carry = t >= 10 ? 1 : 0;
+            dst[i] = static_cast<uint8_t>(t - carry * 10);
+        }
+    }
+
+    /**
+     * @brief Subtracts a digit array from another in place. The result must not be negative.
+     */
+    static void subtractDigits(uint8_t *dst, size_t dstCount, const uint8_t *src, size_t srcCount)
+    {
+        int borrow = 0;
+        size_t i = 0;
+        for (; i < srcCount; i++)
+        {
+            int t = dst[i] - src[i] - borrow;
+            borrow = t < 0 ? 1 : 0;
+            dst[i] = static_cast<uint8_t>(t + borrow * 10);
+        }
+        for (; borrow != 0 && i < dstCount; i++)
+        {
+            int t = dst[i] - borrow;
+            borrow = t < 0 ? 1 : 0;
+            dst[i] = static_cast<uint8_t>(t + borrow * 10);
+        }
+    }
+
+    /**
+     * @brief Returns the digit count of a digit array without its leading zeros, at least 1.
+     */
+    static size_t significantDigits(const uint8_t *digits, size_t count)
+    {
+        while (count > 1 && digits[count - 1] == 0)
+        {
+            count--;
+        }
+        return count;
+    }
+
+    /**
+     * @brief Column-wise (Comba) schoolbook product.
+     *
+     * Each output digit k sums all a[i] * b[k - i] into one 64-bit accumulator, which also holds
+     * the carry from the column below, and is written once; only one division by 10 per column.
+     * Only the columns from first to last - 1 are formed; the partial products of lower columns
+     * are dropped, and so is the carry out of column last - 1 if last is below aCount + bCount.
+     *
+     * @param out Receives digit k at out[k - first]; written, not added to.
+     * @param first First column formed.
+     * @param last One past the last column formed, at most aCount + bCount.
+     */
+    static void combaDigits(const uint8_t *a, size_t aCount, const uint8_t *b, size_t bCount, uint8_t *out,
+                            size_t first = 0, size_t last = std::numeric_limits<size_t>::max())
+    {
+        last = std::min(last, aCount + bCount);
+        // b reversed, so that every column is a forward dot product the compiler can vectorize
+        uint8_t stackCopy[64];
+        std::vector<uint8_t> heapCopy(bCount > 64 ? bCount : 0);
+        uint8_t *reversed = bCount > 64 ? heapCopy.data() : stackCopy;
+        std::reverse_copy(b, b + bCount, reversed);
+        uint64_t accumulator = 0;
+        for (size_t k = first; k < std::min(last, aCount + bCount - 1); k++)
+        {
+            size_t low = k >= bCount ? k - bCount + 1 : 0;
+            size_t high = std::min(k, aCount - 1);
+            const uint8_t *column = reversed + (bCount - 1 - k); // column[i] is b[k - i]
+            uint32_t sum = 0;
+            for (size_t i = low; i <= high; i++)
+            {
+                sum += static_cast<uint32_t>(a[i]) * column[i];
+            }
+            accumulator += sum;
+            out[k - first] = static_cast<uint8_t>(accumulator % 10);
+            accumulator /= 10;
+        }
+        if (last == aCount + bCount)
+        {
+            out[last - 1 - first] = static_cast<uint8_t>(accumulator);
+        }
+    }
+
+    /**
+     * @brief Column K of an N by N digit product, as one unrolled sum.
+     */
+    template <size_t N, size_t K, size_t... I>
+    static uint32_t fixedColumn(const uint8_t *a, const uint8_t *b, std::index_sequence<I...>)
+    {
+        return (0u + ... + ((I <= K && K - I < N) ? static_cast<uint32_t>(a[I]) * b[K - I] : 0u));
+    }
+
+    /**
+     * @brief Comba product of two N-digit arrays with every column unrolled at compile time.
+     */
+    template <size_t N, size_t... K>
+    static void fixedComba(const uint8_t *a, const uint8_t *b, uint8_t *out, std::index_sequence<K...>)
+    {
+        uint32_t accumulator = 0;
+        ((accumulator += fixedColumn<N, K>(a, b, std::make_index_sequence<N>()),
+          out[K] = static_cast<uint8_t>(accumulator % 10), accumulator /= 10),
+         ...);
+        out[2 * N - 1] = static_cast<uint8_t>(accumulator);
+    }
+
+    template <size_t N>
+    static void fixedComba(const uint8_t *a, const uint8_t *b, uint8_t *out)
+    {
+        fixedComba<N>(a, b, out, std::make_index_sequence<2 * N - 1>());
+    }
+
+    /**
+     * @brief Largest operand size with an unrolled product kernel.
+     */
+    static constexpr size_t fixedKernelSize = 16;
+
+    /**
+     * @brief Multiplies two digit arrays of the same size, at most fixedKernelSize, with the unrolled kernel of that size.
+     */
+    template <size_t... N>
+    static void fixedProduct(size_t count, const uint8_t *a, const uint8_t *b, uint8_t *out, std::index_sequence<N...>)
+    {
+        using kernel = void (*)(const uint8_t *, const uint8_t *, uint8_t *);
+        static constexpr kernel kernels[] = {&bigint::fixedComba<N + 1>...};
+        kernels[count - 1](a, b, out);
+    }
+
+    /**
+     * @brief Returns a non-negative bigint holding a digit array.
+     */
+    static bigint fromDigits(const uint8_t *digits, size_t count)
+    {
+        bigint result;
+        result.digits.assign(digits, digits + count);
+        result.removeLeadingZeros();
+        return result;
+    }
+
+    /**
+     * @brief Toom-2.5: multiplies a split in three pieces by b split in two, all of size s.
+     *
+     * With A(x) = a0 + a1 x + a2 x^2 and B(x) = b0 + b1 x, the product C = AB has four
+     * coefficients, recovered from its values at 0, 1, -1 and infinity: four products of size s
+     * instead of the six of schoolbook on the pieces.
+     *
+     * @param out aCount + bCount digits, zero on entry.
+     */
+    static void toom32Digits(const uint8_t *a, size_t aCount, const uint8_t *b, size_t bCount, size_t s, uint8_t *out)
+    {
+        bigint a0 = fromDigits(a, s), a1 = fromDigits(a + s, s), a2 = fromDigits(a + 2 * s, aCount - 2 * s);
+        bigint b0 = fromDigits(b, s), b1 = fromDigits(b + s, bCount - s);
+        bigint evenA = a0 + a2;
+        bigint w0 = a0 * b0;
+        bigint w1 = (evenA + a1) * (b0 + b1);
+        bigint wMinus1 = (evenA - a1) * (b0 - b1);
+        bigint wInfinity = a2 * b1;
+        const bigint two(2);
+        bigint c2 = (w1 + wMinus1) / two - w0;
+        bigint c1 = (w1 - wMinus1) / two - wInfinity;
+        const bigint *coefficients[4] = {&w0, &c1, &c2, &wInfinity};
+        for (size_t i = 0; i < 4; i++)
+        {
+            addDigits(out + i * s, aCount + bCount - i * s, coefficients[i]->digits.data(), coefficients[i]->digits.size());
+        }
+    }
+
+    /**
+     * @brief Toom-3.5: multiplies a split in four pieces by b split in two, all of size s.
+     *
+     * The product has five coefficients, recovered from its values at 0, 1, -1, 2 and infinity
+     * with exact divisions by 2 and 3: five products of size s instead of eight.
+     *
+     * @param out aCount + bCount digits, zero on entry.
+     */
+    static void toom42Digits(const uint8_t *a, size_t aCount, const uint8_t *b, size_t bCount, size_t s, uint8_t *out)
+    {
+        bigint a0 = fromDigits(a, s), a1 = fromDigits(a + s, s), a2 = fromDigits(a + 2 * s, s);
+        bigint a3 = fromDigits(a + 3 * s, aCount - 3 * s);
+        bigint b0 = fromDigits(b, s), b1 = fromDigits(b + s, bCount - s);
+        const bigint two(2);
+        const bigint three(3);
+        bigint evenA = a0 + a2;
+        bigint oddA = a1 + a3;
+        bigint w0 = a0 * b0;
+        bigint w1 = (evenA + oddA) * (b0 + b1);
+        bigint wMinus1 = (evenA - oddA) * (b0 - b1);
+        bigint w2 = (a0 + two * (a1 + two * (a2 + two * a3))) * (b0 + two * b1);
+        bigint wInfinity = a3 * b1;
+        // C(x) = c0 + c1 x + c2 x^2 + c3 x^3 + c4 x^4
+        bigint c2 = (w1 + wMinus1) / two - w0 - wInfinity;
+        bigint odd = (w1 - wMinus1) / two; // c1 + c3
+        bigint c3 = ((w2 - w0 - bigint(4) * c2 - bigint(16) * wInfinity) / two - odd) / three;
+        bigint c1 = odd - c3;
+        const bigint *coefficients[5] = {&w0, &c1, &c2, &c3, &wInfinity};
+        for (size_t i = 0; i < 5; i++)
+        {
+            addDigits(out + i * s, aCount + bCount - i * s, coefficients[i]->digits.data(), coefficients[i]->digits.size());
+        }
+    }
+
+    /**
+     * @brief Shorter operand size in digits from which products use the NTT.
+     */
+    static constexpr size_t nttThreshold = 1500;
+
+    /**
+     * @brief How a product is laid out for the NTT.
+     *
+     * Digits are packed group at a time into base 10^group coefficients. The longer operand is
+     * cut into pieces of piece digits, each convolved with the whole shorter operand, so the
+     * shorter operand is transformed once.
+     */
+    struct nttLayout
+    {
+        ntt_plan plan;
+        unsigned group = 1;
+        size_t piece = 0;
+    };
+
+    /**
+     * @brief The forward transforms of one operand or piece, one per prime of its layout.
+     */
+    using nttTransform = std::vector<std::vector<uint32_t>>;
+
+    /**
+     * @brief Picks the cheapest layout for a product: digits per coefficient and transform size.
+     *
+     * A transform of n points costs about n log n per prime; the shorter operand takes one
+     * forward transform and every piece of the longer one a forward and an inverse.
+     */
+    static nttLayout nttLayoutFor(size_t longer, size_t shorter)
+    {
+        nttLayout best;
+        double bestCost = 0;
+        uint64_t base = 1;
+        for (unsigned group = 1; group <= 4; group++)
+        {
+            base *= 10;
+            size_t shortCoefficients = (shorter + group - 1) / group;
+            size_t longCoefficients = (longer + group - 1) / group;
+            uint64_t bound = shortCoefficients * (base - 1) * (base - 1);
+            unsigned log = 1;
+            while ((size_t(1) << log) <= shortCoefficients)
+                log++;
+            for (; (size_t(1) << (log - 1)) < longCoefficients + shortCoefficients; log++)
+            {
+                ntt_plan plan;
+                if (!ntt::make_plan(bound, size_t(1) << log, plan))
+                    break;
+                size_t pieceCoefficients = (size_t(1) << log) - shortCoefficients + 1;
+                size_t pieces = (longCoefficients + pieceCoefficients - 1) / pieceCoefficients;
+                double cost = static_cast<double>(plan.prime_count * (2 * pieces + 1)) * static_cast<double>(size_t(1) << log) * log;
+                if (best.plan.prime_count == 0 || cost < bestCost)
+                {
+                    best.plan = plan;
+                    best.group = group;
+                    best.piece = pieceCoefficients * group;
+                    bestCost = cost;
+                }
+            }
+        }
+        if (best.plan.prime_count == 0)
+            throw std::length_error("Product too large for the NTT");
+        return best;
+    }
+
+    /**
+     * @brief Packs a digit array into coefficients and transforms it for every prime of a layout.
+     */
+    static nttTransform nttForward(const uint8_t *digits, size_t count, const nttLayout &layout, unsigned threads)
+    {
+        std::vector<uint32_t> packed(size_t(1) << layout.plan.log, 0);
+        for (size_t i = 0; i < count; i += layout.group)
+        {
+            uint32_t value = 0;
+            for (size_t k = std::min<size_t>(count, i + layout.group); k > i; k--)
+                value = value * 10 + digits[k - 1];
+            packed[i / layout.group] = value;
+        }
+        nttTransform transform(layout.plan.prime_count);
+        for (unsigned p = 0; p < layout.plan.prime_count; p++)
+        {
+            transform[p] = p + 1 < layout.plan.prime_count ? packed : std::move(packed);
+            ntt::forward(layout.plan.primes[p], transform[p].data(), layout.plan.log, threads);
+        }
+        return transform;
+    }
+
+    /**
+     * @brief Multiplies a transform by another, transforms back and adds the product to a digit array.
+     *
+     * @param product The first transform, overwritten.
+     * @param other The second transform.
+     * @param count Digits of the product.
+     * @param out The digits to add to, outCount of them.
+     */
+    static void nttFinish(nttTransform &product, const nttTransform &other, const nttLayout &layout, size_t count,
+                          uint8_t *out, size_t outCount, unsigned threads)
+    {
+        const ntt_plan &plan = layout.plan;
+        for (unsigned p = 0; p < plan.prime_count; p++)
+        {
+            ntt::pointwise(plan.primes[p], product[p].data(), other[p].data(), plan.log);
+            ntt::inverse(plan.primes[p], product[p].data(), plan.log, threads);
+        }
+        uint64_t carry = 0;
+        uint8_t addCarry = 0;
+        uint32_t residues[3];
+        size_t n = size_t(1) << plan.log;
+        for (size_t c = 0; c * layout.group < count; c++)
+        {
+            // the last digits of the product may lie past the convolution, in its carries
+            if (c < n)
+            {
+                for (unsigned p = 0; p < plan.prime_count; p++)
+                    residues[p] = product[p][c];
+                carry += ntt::combine(plan, residues);
+            }
+            for (size_t k = c * layout.group; k < std::min<size_t>(count, (c + 1) * layout.group); k++)
+            {
+                uint8_t sum = static_cast<uint8_t>(out[k] + carry % 10 + addCarry);
+                carry /= 10;
+                addCarry = sum >= 10;
+                out[k] = addCarry ? sum - 10 : sum;
+            }
+        }
+        for (size_t k = count; addCarry != 0 && k < outCount; k++)
+        {
+            addCarry = out[k] == 9;
+            out[k] = addCarry ? 0 : out[k] + 1;
+        }
+    }
+
+    /**
+     * @brief Adds the product of two digit arrays to out with the NTT, given the transform of the shorter one.
+     *
+     * @param a The longer operand, cut into pieces of the layout.
+     * @param bTransform The transform of the shorter operand, of bCount digits.
+     * @param out aCount + bCount digits.
+     */
+    static void nttProduct(const uint8_t *a, size_t aCount, size_t bCount, const nttLayout &layout,
+                           const nttTransform &bTransform, uint8_t *out, unsigned threads)
+    {
+        for (size_t start = 0; start < aCount; start += layout.piece)
+        {
+            size_t length = std::min(layout.piece, aCount - start);
+            nttTransform piece = nttForward(a + start, length, layout, threads);
+            nttFinish(piece, bTransform, layout, length + bCount, out + start, aCount + bCount - start, threads);
+        }
+    }
+
+    /**
+     * @brief Computes the full product of two digit arrays.
+     *
+     * Schoolbook below karatsubaThreshold and NTT from nttThreshold. In between the split depends
+     * on the length ratio r of the operands: Karatsuba below 1.3, Toom-2.5 below 1.75, Toom-3.5
+     * below 2.5, and from there the longer operand is cut into pieces of the shorter one's length,
+     * each multiplied as a balanced product.
+     *
+     * @param out aCount + bCount digits, zero on entry.
+     */
+    static void multiplyDigits(const uint8_t *a, size_t aCount, const uint8_t *b, size_t bCount, uint8_t *out)
+    {
+        if (aCount < bCount)
+        {
+            std::swap(a, b);
+            std::swap(aCount, bCount);
+        }
+        if (aCount == bCount && aCount <= fixedKernelSize)
+        {
+            fixedProduct(aCount, a, b, out, std::make_index_sequence<fixedKernelSize>());
+            return;
+        }
+        if (bCount < karatsubaThreshold)
+        {
+            combaDigits(a, aCount, b, bCount, out);
+            return;
+        }
+        if (bCount >= nttThreshold)
+        {
+            nttLayout layout = nttLayoutFor(aCount, bCount);
+            unsigned threads = max_threads();
+            nttProduct(a, aCount, bCount, layout, nttForward(b, bCount, layout, threads), out, threads);
+            return;
+        }
+        if (10 * aCount >= 13 * bCount && 4 * aCount < 7 * bCount)
+        {
+            size_t s = std::max((aCount + 2) / 3, (bCount + 1) / 2);
+            toom32Digits(a, aCount, b, bCount, s, out);
+            return;
+        }
+        if (4 * aCount >= 7 * bCount && 2 * aCount < 5 * bCount)
+        {
+            size_t s = std::max((aCount + 3) / 4, (bCount + 1) / 2);
+            toom42Digits(a, aCount, b, bCount, s, out);
+            return;
+        }
+        if (2 * aCount >= 5 * bCount)
+        {
+            std::vector<uint8_t> piece(2 * bCount);
+            for (size_t start = 0; start < aCount; start += bCount)
+            {
+                size_t length = std::min(bCount, aCount - start);
+                std::fill(piece.begin(), piece.end(), 0);
+                multiplyDigits(a + start, length, b, bCount, piece.data());
+                addDigits(out + start, aCount + bCount - start, piece.data(), length + bCount);
+            }
+            return;
+        }
+
+        // a = a1 * 10^h + a0, b = b1 * 10^h + b0, with b1 not empty since aCount < 1.3 * bCount
+        size_t h = (aCount + 1) / 2;
+        multiplyDigits(a, h, b, h, out);                                 // a0 * b0
+        multiplyDigits(a + h, aCount - h, b + h, bCount - h, out + 2 * h); // a1 * b1
+
+        std::vector<uint8_t> sumA(a, a + h);
+        sumA.push_back(0);
+        addDigits(sumA.data(), h + 1, a + h, aCount - h);
+        std::vector<uint8_t> sumB(b, b + h);
+        sumB.push_back(0);
+        addDigits(sumB.data(), h + 1, b + h, bCount - h);
+        std::vector<uint8_t> middle(2 * h + 2, 0);
+        multiplyDigits(sumA.data(), h + 1, sumB.data(), h + 1, middle.data());
+        // (a0 + a1)(b0 + b1) - a0 b0 - a1 b1 = a0 b1 + a1 b0
+        subtractDigits(middle.data(), middle.size(), out, 2 * h);
+        subtractDigits(middle.data(), middle.size(), out + 2 * h, aCount + bCount - 2 * h);
+        addDigits(out + h, aCount + bCount - h, middle.data(), significantDigits(middle.data(), middle.size()));
+    }
+
+    /**
+     * @brief Computes the low count digits of the product of two digit arrays.
+     *
+     * Only the partial products below digit count are formed. Above karatsubaThreshold it uses
+     * Mulders' short product: with a split at k = 0.7 count, a0 * b0 is a full product and the two
+     * cross products are short products of count - k digits; a1 * b1 lies entirely above count.
+     *
+     * @param out count digits, zero on entry.
+     */
+    static void mulLowDigits(const uint8_t *a, size_t aCount, const uint8_t *b, size_t bCount, size_t count, uint8_t *out)
+    {
+        aCount = std::min(aCount, count);
+        bCount = std::min(bCount, count);
+        if (aCount + bCount <= count)
+        {
+            multiplyDigits(a, aCount, b, bCount, out);
+            return;
+        }
+        if (std::min(aCount, bCount) < karatsubaThreshold)
+        {
+            combaDigits(a, aCount, b, bCount, out, 0, count);
+            return;
+        }
+
+        size_t k = std::min(count - 1, std::max(count / 2 + 1, (7 * count + 9) / 10));
+        size_t a0 = std::min(aCount, k);
+        size_t b0 = std::min(bCount, k);
+        std::vector<uint8_t> product(a0 + b0, 0);
+        multiplyDigits(a, a0, b, b0, product.data());
+        addDigits(out, count, product.data(), std::min(product.size(), count));
+        std::vector<uint8_t> cross(count - k);
+        if (aCount > k)
+        {
+            mulLowDigits(a + k, aCount - k, b, b0, count - k, cross.data());
+            addDigits(out + k, count - k, cross.data(), cross.size());
+        }
+        if (bCount > k)
+        {
+            std::fill(cross.begin(), cross.end(), 0);
+            mulLowDigits(a, a0, b + k, bCount - k, count - k, cross.data());
+            addDigits(out + k, count - k, cross.data(), cross.size());
+        }
+    }
+
+    /**
+     * @brief Writes an approximation of the product of two count-digit arrays into out that
+     * contains at least every partial product a[i] * b[j] with i + j >= count - 1.
+     *
+     * Schoolbook below karatsubaThreshold. Above it, Mulders' upper short product: with the top
+     * l = 0.7 count digits of each operand, a_hi * b_hi is a full product, each cross product only
+     * reaches the wanted columns through count - l digits of each side and is again an upper short
+     * product, and a_lo * b_lo lies entirely below the wanted columns.
+     *
+     * @param out 2 * count digits, zero on entry.
+     */
+    static void mulHighDigits(const uint8_t *a, const uint8_t *b, size_t count, uint8_t *out)
+    {
+        if (count < karatsubaThreshold)
+        {
+            combaDigits(a, count, b, count, out + count - 1, count - 1);
+            return;
+        }
+
+        size_t l = std::min(count - 1, std::max(count / 2 + 1, (7 * count + 9) / 10));
+        size_t k = count - l;
+        std::vector<uint8_t> product(2 * l, 0);
+        multiplyDigits(a + k, l, b + k, l, product.data());
+        addDigits(out + 2 * k, 2 * l, product.data(), product.size());
+        // a_hi * b_lo: only the top k digits of a_hi reach column count - 1, and the same mirrored
+        std::vector<uint8_t> cross(2 * k, 0);
+        mulHighDigits(a + count - k, b, k, cross.data());
+        addDigits(out + count - k, count + k, cross.data(), cross.size());
+        std::fill(cross.begin(), cross.end(), 0);
+        mulHighDigits(a, b + count - k, k, cross.data());
+        addDigits(out + count - k, count + k, cross.data(), cross.size());
+    }
+
+    /**
+     * @brief Writes the decimal digits of a machine word, least significant first.
+     *
+     * @param value The word.
+     * @param out Receives the digits, room for 20 is needed.
+     * @return The number of digits written.
+     */
+    static size_t wordDigits(uint64_t value, uint8_t *out)
+    {
+        size_t count = 0;
+        do
+        {
+            out[count++] = static_cast<uint8_t>(value % 10);
+            value /= 10;
+        } while (value != 0);
+        return count;
+    }
+
+public:
+    /**
+     * @brief Registers an observer that is told about every top-level operation.
+     *
+     * @param observer The observer. It must stay alive until it is removed and no operation is running.
+     * @return True on success, false if all observer slots are taken.
+     */
+    static bool add_observer(bigint_observer *observer)
+    {
+        observerRegistry &registry = observers();
+        for (std::atomic<bigint_observer *> &slot : registry.slots)
+        {
+            bigint_observer *empty = nullptr;
+            if (slot.compare_exchange_strong(empty, observer, std::memory_order_acq_rel))
+            {
+                registry.count.fetch_add(1, std::memory_order_release);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Unregisters an observer added with add_observer.
+     *
+     * @param observer The observer to remove.
+     */
+    static void remove_observer(bigint_observer *observer)
+    {
+        observerRegistry &registry = observers();
+        for (std::atomic<bigint_observer *> &slot : registry.slots)
+        {
+            bigint_observer *expected = observer;
+            if (slot.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel))
+            {
+                registry.count.fetch_sub(1, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Returns the number of decimal digits of the magnitude (1 for zero).
+     */
+    size_t digit_count() const
+    {
+        return digits.size();
+    }
+
+    /**
+     * @brief Returns whether the bigint is negative.
+     */
+    bool negative() const
+    {
+        return is_negative;
+    }
+
+    /**
+     * @brief Returns the leading digits of the magnitude as an integer.
+     *
+     * @param count Number of leading digits wanted, at most 19 so that the result fits in 64 bits.
+     * @return The value of the first min(count, 19, digit_count()) digits.
+     */
+    uint64_t top_digits(size_t count) const
+    {
+        count = std::min<size_t>(std::min<size_t>(count, 19), digits.size());
+        uint64_t value = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            value = value * 10 + digits[digits.size() - 1 - i];
+        }
+        return value;
+    }
+
+    /**
+     * @brief Approximate value of a bigint: mantissa * 2^exponent.
+     */
+    struct approx_magnitude
+    {
+        uint64_t mantissa; // Top bit set, or 0 for zero
+        int64_t exponent;  // Binary exponent of the least significant mantissa bit
+        bool negative;
+    };
+
+    /**
+     * @brief Returns the approximate magnitude in O(1) from the leading 19 digits.
+     *
+     * With an 80-bit long double the relative error is about 2^-40 for a million digits and
+     * smaller for shorter numbers, since the exponent takes up less of the precision.
+     *
+     * @return The sign, a normalized 64-bit mantissa and a binary exponent.
+     */
+    approx_magnitude approx() const
+    {
+        uint64_t leading = top_digits(19);
+        if (leading == 0)
+        {
+            return approx_magnitude{0, 0, false};
+        }
+        size_t used = std::min<size_t>(19, digits.size());
+        long double log2Value = std::log2(static_cast<long double>(leading)) +
+                                static_cast<long double>(digits.size() - used) * 3.321928094887362347870319429489390175865L;
+        long double whole = std::floor(log2Value);
+        long double scaled = std::exp2(log2Value - whole + 63);
+        uint64_t mantissa = scaled >= 18446744073709551615.0L ? std::numeric_limits<uint64_t>::max() : static_cast<uint64_t>(scaled);
+        mantissa = std::max(mantissa, uint64_t(1) << 63);
+        return approx_magnitude{mantissa, static_cast<int64_t>(whole) - 63, is_negative};
+    }
+
+    /**
+     * @brief Returns an approximation of log10(|x|) in O(1), or -infinity for zero.
+     */
+    double log10_approx() const
+    {
+        uint64_t leading = top_digits(19);
+        if (leading == 0)
+        {
+            return -std::numeric_limits<double>::infinity();
+        }
+        size_t used = std::min<size_t>(19, digits.size());
+        return static_cast<double>(digits.size() - used) + std::log10(static_cast<double>(leading));
+    }
+
+    /**
+     * @brief Returns an approximation of log2(|x|) in O(1), or -infinity for zero.
+     */
+    double log2_approx() const
+    {
+        return log10_approx() * 3.321928094887362;
+    }
+
+    /**
+     * @brief Three-way comparison with another bigint.
+     *
+     * Signs and digit counts are compared first, then the digits eight at a time from the top.
+     *
+     * @param other The bigint to compare with.
+     * @return Negative, zero or positive as *this is smaller, equal or larger than other.
+     */
+    int compare(const bigint &other) const
+    {
+        if (is_negative != other.is_negative)
+        {
+            return is_negative ? -1 : 1;
+        }
+        int magnitude = compareMagnitude(other);
+        return is_negative ? -magnitude : magnitude;
+    }
+
     /**
-     * @brief Removes leading zeros from the digits.
+     * @brief Sets the number of threads parallel algorithms may use.
      *
-     * This function is used to preventing case happen like 0001.
+     * @param threads The thread limit, 0 means one per hardware thread.
      */
-    void removeLeadingZeros()
+    static void set_max_threads(unsigned threads)
     {
-        while (digits.size() > 1 && digits.back() == 0)
-        {
-            digits.pop_back();
-        }
-        if (digits.size() == 1 && digits[0] == 0)
-        {
-            is_negative = false; // Zero is not negative
-        }
+        threadLimit().store(threads, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the number of threads parallel algorithms may use.
+     *
+     * @return The thread limit, at least 1.
+     */
+    static unsigned max_threads()
+    {
+        static const unsigned hardware = std::max(1u, std::thread::hardware_concurrency());
+        unsigned limit = threadLimit().load(std::memory_order_relaxed);
+        return limit == 0 ? hardware : limit;
     }
 
-public:
     /**
      * @brief Default constructor, initializes the integer to 0.
      */
@@ -56,7 +1394,7 @@ public:
      *
      * @param value The signed 64-bit integer to convert.
      */
-    bigint(int64_t value)
+    bigint(int64_t value) : is_negative(false)
     {
         digits.clear();
         if (value < 0)
@@ -83,7 +1421,6 @@ public:
      */
     bigint(const std::string &value)
     {
-        digits.clear();
         if (value.empty())
             throw std::invalid_argument("Invalid input string");
         size_t start = 0;
@@ -93,15 +1430,220 @@ public:
             is_negative = true;
             start = 1;
         }
+        size_t count = value.size() - start;
+        if (count == 0)
+            throw std::invalid_argument("Invalid input string");
+
+        digits.resize(count);
+        if (convertDigits(value.data() + start, count, digits.data()) != count)
+            throw std::invalid_argument("Invalid digit in string");
+
+        removeLeadingZeros();
+    }
+
+    /**
+     * @brief Parses a string of digits without throwing.
+     *
+     * Meant for bulk ingest, where invalid fields are expected and exceptions are too slow.
+     *
+     * @param value The string to parse, optionally starting with '-'.
+     * @param result Receives the parsed number on success, unchanged otherwise.
+     * @return std::string::npos on success, otherwise the position of the first invalid character
+     *         (the string size if there are no digits at all).
+     */
+    static size_t parse(const std::string &value, bigint &result)
+    {
+        size_t start = !value.empty() && value[0] == '-' ? 1 : 0;
+        size_t count = value.size() - start;
+        if (count == 0)
+            return value.size();
+
+        bigint parsed;
+        parsed.digits.resize(count);
+        size_t invalid = convertDigits(value.data() + start, count, parsed.digits.data());
+        if (invalid != count)
+            return start + invalid;
+        parsed.is_negative = start == 1;
+        parsed.removeLeadingZeros();
+        result = std::move(parsed);
+        return std::string::npos;
+    }
+
+    /**
+     * @brief Options controlling how format_to prints a bigint.
+     *
+     * Mirrors the standard format specification: [[fill]align][sign][#][0][width][grouping][type].
+     */
+    struct format_spec
+    {
+        char fill = ' ';        // Padding character
+        char align = 0;         // '<', '>', '^', or 0 for the default (right)
+        char sign = '-';        // '-', '+' or ' '
+        bool alternate = false; // '#': radix prefix 0x/0b/0
+        bool zero_pad = false;  // '0': pad with zeros after the sign and prefix
+        size_t width = 0;       // Minimum field width
+        char grouping = 0;      // ',' or '_' every 3 (decimal) or 4 (other bases) digits, 0 for none
+        char type = 'd';        // 'd', 'x', 'X', 'o', 'b' or 'B'
+    };
 
-        for (size_t i = value.size(); i > start; i--)
+    /**
+     * @brief Parses a format specification such as "*^+#020,x".
+     *
+     * @param begin Start of the specification.
+     * @param end End of the specification.
+     * @param spec Receives the parsed options.
+     * @return Iterator to the first character that is not part of the specification.
+     */
+    template <typename Iterator>
+    static constexpr Iterator parse_format_spec(Iterator begin, Iterator end, format_spec &spec)
+    {
+        Iterator it = begin;
+        if (end - it >= 2 && (it[1] == '<' || it[1] == '>' || it[1] == '^') && it[0] != '{' && it[0] != '}')
+        {
+            spec.fill = it[0];
+            spec.align = it[1];
+            it += 2;
+        }
+        else if (it != end && (*it == '<' || *it == '>' || *it == '^'))
+        {
+            spec.align = *it++;
+        }
+        if (it != end && (*it == '+' || *it == '-' || *it == ' '))
+        {
+            spec.sign = *it++;
+        }
+        if (it != end && *it == '#')
         {
-            if (!std::isdigit(value[i - 1]))
-                throw std::invalid_argument("Invalid digit in string");
-            digits.push_back(static_cast<uint8_t>(value[i - 1] - '0'));
+            spec.alternate = true;
+            it++;
         }
+        if (it != end && *it == '0')
+        {
+            spec.zero_pad = true;
+            it++;
+        }
+        while (it != end && *it >= '0' && *it <= '9')
+        {
+            spec.width = spec.width * 10 + static_cast<size_t>(*it++ - '0');
+        }
+        if (it != end && (*it == ',' || *it == '_'))
+        {
+            spec.grouping = *it++;
+        }
+        if (it != end && (*it == 'd' || *it == 'x' || *it == 'X' || *it == 'o' || *it == 'b' || *it == 'B'))
+        {
+            spec.type = *it++;
+        }
+        return it;
+    }
 
-        removeLeadingZeros();
+    /**
+     * @brief Writes the bigint to an output iterator according to a format specification.
+     *
+     * Decimal output is written straight from the digits, without an intermediate string;
+     * other bases convert the digits first.
+     *
+     * @param out The output iterator, e.g. a std::back_insert_iterator or a std::format context iterator.
+     * @param spec The formatting options.
+     * @return The output iterator past the last written character.
+     */
+    template <typename OutputIt>
+    OutputIt format_to(OutputIt out, const format_spec &spec) const
+    {
+        unsigned base = spec.type == 'x' || spec.type == 'X' ? 16 : spec.type == 'o' ? 8 : spec.type == 'b' || spec.type == 'B' ? 2 : 10;
+        std::vector<uint8_t> converted;
+        if (base != 10)
+        {
+            converted = toRadix(base);
+        }
+        const std::vector<uint8_t> &body = base == 10 ? digits : converted;
+        const char *symbols = spec.type == 'X' ? "0123456789ABCDEF" : "0123456789abcdef";
+
+        char signChar = is_negative ? '-' : spec.sign == '+' ? '+' : spec.sign == ' ' ? ' ' : 0;
+        const char *prefix = "";
+        if (spec.alternate)
+        {
+            prefix = base == 16 ? (spec.type == 'X' ? "0X" : "0x") : base == 2 ? (spec.type == 'B' ? "0B" : "0b") : base == 8 ? "0" : "";
+        }
+        size_t prefixLength = std::char_traits<char>::length(prefix);
+
+        size_t count = body.size();
+        size_t group = spec.grouping == 0 ? 0 : base == 10 ? 3 : 4;
+        size_t separators = group == 0 ? 0 : (count - 1) / group;
+        size_t length = (signChar != 0 ? 1 : 0) + prefixLength + count + separators;
+        size_t padding = spec.width > length ? spec.width - length : 0;
+
+        // zero padding only applies when no alignment was given
+        bool zeroPad = spec.zero_pad && spec.align == 0;
+        size_t before = 0;
+        size_t after = 0;
+        if (!zeroPad)
+        {
+            if (spec.align == '<')
+            {
+                after = padding;
+            }
+            else if (spec.align == '^')
+            {
+                before = padding / 2;
+                after = padding - before;
+            }
+            else
+            {
+                before = padding;
+            }
+        }
+
+        for (size_t i = 0; i < before; i++)
+        {
+            *out++ = spec.fill;
+        }
+        if (signChar != 0)
+        {
+            *out++ = signChar;
+        }
+        for (size_t i = 0; i < prefixLength; i++)
+        {
+            *out++ = prefix[i];
+        }
+        for (size_t i = 0; zeroPad && i < padding; i++)
+        {
+            *out++ = '0';
+        }
+        for (size_t i = count; i > 0; i--)
+        {
+            *out++ = symbols[body[i - 1]];
+            if (group != 0 && i - 1 != 0 && (i - 1) % group == 0)
+            {
+                *out++ = spec.grouping;
+            }
+        }
+        for (size_t i = 0; i < after; i++)
+        {
+            *out++ = spec.fill;
+        }
+        return out;
+    }
+
+    /**
+     * @brief Converts the bigint to its decimal string representation.
+     *
+     * Large numbers are converted in parallel, each task writing its digits at their final offset.
+     *
+     * @return The decimal representation, with a leading '-' for negative numbers.
+     */
+    std::string to_string() const
+    {
+        size_t sign = is_negative ? 1 : 0;
+        size_t count = digits.size();
+        std::string result(sign + count, '-');
+        char *text = &result[sign];
+        const uint8_t *in = digits.data();
+        parallelRange(0, count, conversionGrain, max_threads(), [&](size_t begin, size_t end)
+                      {
+            // digits [begin, end) become characters [count - end, count - begin)
+            formatDigits(in + begin, end - begin, text + count - end); });
+        return result;
     }
 
     /**
@@ -154,6 +1696,7 @@ public:
      */
     bigint operator+(const bigint &other) const
     {
+        operationScope scope(bigint_op::add, *this, &other);
         // both number have same sign
         if (is_negative == other.is_negative)
         {
@@ -249,6 +1792,7 @@ public:
      */
     bigint operator-(const bigint &other) const
     {
+        operationScope scope(bigint_op::subtract, *this, &other);
         // Same sign (both positive or both negative)
         if (is_negative == other.is_negative)
         {
@@ -348,26 +1892,13 @@ public:
      */
     bigint operator*(const bigint &other) const
     {
+        operationScope scope(bigint_op::multiply, *this, &other);
         bigint result;
-        result.digits.clear();
         // set sign
         result.is_negative = (is_negative != other.is_negative);
         // set digits
-        result.digits.resize(digits.size() + other.digits.size(), 0);
-        // multiplication digits by digits
-        for (size_t i = 0; i < digits.size(); i++)
-        {
-            int carry = 0;
-            for (size_t j = 0; j < other.digits.size(); j++)
-            {
-                int multi = digits[i] * other.digits[j] + result.digits[i + j] + carry;
-                result.digits[i + j] = static_cast<uint8_t>(multi % 10); // Store the result digit
-                carry = multi / 10;
-            }
-            // add leftover carry to next position
-            result.digits[i + other.digits.size()] += carry;
-        }
-
+        result.digits.assign(digits.size() + other.digits.size(), 0);
+        multiplyDigits(digits.data(), digits.size(), other.digits.data(), other.digits.size(), result.digits.data());
         result.removeLeadingZeros();
         return result;
     }
@@ -384,6 +1915,244 @@ public:
         return *this;
     }
 
+    /**
+     * @brief Division operator for two bigints, rounding toward zero like the built-in integers.
+     *
+     * @param other The divisor.
+     * @return A new bigint containing the quotient.
+     * @throws std::invalid_argument If the divisor is zero.
+     */
+    bigint operator/(const bigint &other) const
+    {
+        operationScope scope(bigint_op::divide, *this, &other);
+        if (other.isZero())
+            throw std::invalid_argument("Division by zero");
+        bigint quotient;
+        bigint remainder;
+        divideMagnitude(other, quotient, remainder);
+        quotient.is_negative = is_negative != other.is_negative;
+        quotient.removeLeadingZeros();
+        return quotient;
+    }
+
+    /**
+     * @brief Division assignment operator.
+     *
+     * @param other The divisor.
+     * @return The updated bigint.
+     */
+    bigint &operator/=(const bigint &other)
+    {
+        *this = *this / other;
+        return *this;
+    }
+
+    /**
+     * @brief Modulo operator for two bigints. The remainder takes the sign of the dividend.
+     *
+     * @param other The divisor.
+     * @return A new bigint containing the remainder.
+     * @throws std::invalid_argument If the divisor is zero.
+     */
+    bigint operator%(const bigint &other) const
+    {
+        operationScope scope(bigint_op::modulo, *this, &other);
+        if (other.isZero())
+            throw std::invalid_argument("Division by zero");
+        bigint quotient;
+        bigint remainder;
+        divideMagnitude(other, quotient, remainder);
+        remainder.is_negative = is_negative;
+        remainder.removeLeadingZeros();
+        return remainder;
+    }
+
+    /**
+     * @brief Modulo assignment operator.
+     *
+     * @param other The divisor.
+     * @return The updated bigint.
+     */
+    bigint &operator%=(const bigint &other)
+    {
+        *this = *this % other;
+        return *this;
+    }
+
+    /**
+     * @brief Low half of a product: the last n digits of a * b.
+     *
+     * Partial products that only affect digits from n upward are never formed, which saves about
+     * half of a schoolbook product and a quarter of a Karatsuba one.
+     *
+     * @param a First factor.
+     * @param b Second factor.
+     * @param n Number of digits kept.
+     * @return (|a| * |b|) mod 10^n, with the sign of a * b.
+     */
+    static bigint mul_low(const bigint &a, const bigint &b, size_t n)
+    {
+        bigint result;
+        if (n == 0)
+        {
+            return result;
+        }
+        result.digits.assign(n, 0);
+        mulLowDigits(a.digits.data(), a.digits.size(), b.digits.data(), b.digits.size(), n, result.digits.data());
+        result.is_negative = a.is_negative != b.is_negative;
+        result.removeLeadingZeros();
+        return result;
+    }
+
+    /**
+     * @brief High half of a product: a * b without its last n digits.
+     *
+     * Only the partial products reaching digit n - g are formed, g being a few guard digits. The
+     * dropped ones add less than 10^(n - 3), so the truncated sum can be off by one in digit n only
+     * when its digits n - 3 to n - 1 are all 9; in that rare case the full product is computed
+     * instead. The result is always exact.
+     *
+     * @param a First factor.
+     * @param b Second factor.
+     * @param n Number of low digits dropped.
+     * @return |a| * |b| / 10^n rounded down, with the sign of a * b.
+     */
+    static bigint mul_high(const bigint &a, const bigint &b, size_t n)
+    {
+        size_t aCount = a.digits.size();
+        size_t bCount = b.digits.size();
+        size_t shorter = std::min(aCount, bCount);
+        uint8_t boundDigits[20];
+        // at most shorter partial products per column, each below 10^2: dropped columns sum below 9 * shorter * 10^cut
+        size_t guard = wordDigits(9 * static_cast<uint64_t>(shorter), boundDigits) + 3;
+        if (n >= aCount + bCount)
+        {
+            return bigint();
+        }
+        std::vector<uint8_t> product;
+        size_t offset = 0; // product[i] is digit offset + i of the approximation
+        bool full = n < guard;
+        if (!full)
+        {
+            size_t cut = n - guard;
+            size_t longer = std::max(aCount, bCount);
+            if (shorter < karatsubaThreshold || longer >= 2 * shorter)
+            {
+                // schoolbook over the columns from cut upward
+                offset = cut;
+                product.assign(aCount + bCount - cut, 0);
+                combaDigits(a.digits.data(), aCount, b.digits.data(), bCount, product.data(), cut);
+            }
+            else
+            {
+                // upper short product on operands padded to the same length; t low zeros move its
+                // guaranteed columns, count - 1 and up, down to cut
+                size_t shift = longer - 1 > cut ? longer - 1 - cut : 0;
+                size_t count = longer + shift;
+                std::vector<uint8_t> x(count, 0);
+                std::vector<uint8_t> y(count, 0);
+                std::copy(a.digits.begin(), a.digits.end(), x.begin() + static_cast<std::ptrdiff_t>(shift));
+                std::copy(b.digits.begin(), b.digits.end(), y.begin() + static_cast<std::ptrdiff_t>(shift));
+                std::vector<uint8_t> upper(2 * count, 0);
+                mulHighDigits(x.data(), y.data(), count, upper.data());
+                offset = 0;
+                product.assign(upper.begin() + static_cast<std::ptrdiff_t>(2 * shift), upper.end());
+            }
+            // correction step: a carry from the dropped columns can only reach digit n through 999
+            full = product[n - 1 - offset] == 9 && product[n - 2 - offset] == 9 && product[n - 3 - offset] == 9;
+        }
+        if (full)
+        {
+            product.assign(aCount + bCount, 0);
+            offset = 0;
+            multiplyDigits(a.digits.data(), aCount, b.digits.data(), bCount, product.data());
+        }
+        bigint result;
+        result.digits.assign(product.begin() + static_cast<std::ptrdiff_t>(n - offset), product.end());
+        result.is_negative = a.is_negative != b.is_negative;
+        result.removeLeadingZeros();
+        return result;
+    }
+
+    /**
+     * @brief Fused multiply-add: adds a * b to this bigint.
+     *
+     * The partial products are accumulated directly into the digits of *this, without a temporary
+     * product or a separate addition pass.
+     *
+     * @param a The first factor.
+     * @param b The second factor.
+     * @return The updated bigint.
+     */
+    bigint &addmul(const bigint &a, const bigint &b)
+    {
+        if (&a == this || &b == this)
+        {
+            bigint copy = *this;
+            return addmul(&a == this ? copy : a, &b == this ? copy : b);
+        }
+        mulAccumulate(a.digits.data(), a.digits.size(), b.digits.data(), b.digits.size(), a.is_negative != b.is_negative);
+        return *this;
+    }
+
+    /**
+     * @brief Fused multiply-subtract: subtracts a * b from this bigint.
+     *
+     * @param a The first factor.
+     * @param b The second factor.
+     * @return The updated bigint.
+     */
+    bigint &submul(const bigint &a, const bigint &b)
+    {
+        if (&a == this || &b == this)
+        {
+            bigint copy = *this;
+            return submul(&a == this ? copy : a, &b == this ? copy : b);
+        }
+        mulAccumulate(a.digits.data(), a.digits.size(), b.digits.data(), b.digits.size(), a.is_negative == b.is_negative);
+        return *this;
+    }
+
+    /**
+     * @brief Adds a times a machine word to this bigint.
+     *
+     * @param a The bigint factor.
+     * @param b The word factor.
+     * @return The updated bigint.
+     */
+    bigint &addmul(const bigint &a, uint64_t b)
+    {
+        if (&a == this)
+        {
+            bigint copy = *this;
+            return addmul(copy, b);
+        }
+        uint8_t word[20];
+        size_t count = wordDigits(b, word);
+        mulAccumulate(a.digits.data(), a.digits.size(), word, count, a.is_negative);
+        return *this;
+    }
+
+    /**
+     * @brief Subtracts a times a machine word from this bigint.
+     *
+     * @param a The bigint factor.
+     * @param b The word factor.
+     * @return The updated bigint.
+     */
+    bigint &submul(const bigint &a, uint64_t b)
+    {
+        if (&a == this)
+        {
+            bigint copy = *this;
+            return submul(copy, b);
+        }
+        uint8_t word[20];
+        size_t count = wordDigits(b, word);
+        mulAccumulate(a.digits.data(), a.digits.size(), word, count, !a.is_negative);
+        return *this;
+    }
+
     /**
      * @brief Negation operator for bigints.
      *
@@ -424,61 +2193,7 @@ public:
      */
     bool operator<(const bigint &other) const
     {
-        // different sign
-        if (is_negative && !other.is_negative)
-        {
-            return true;
-        }
-        if (!is_negative && other.is_negative)
-        {
-            return false;
-        }
-        // same sign
-        // different number digits
-        if (digits.size() < other.digits.size())
-        {
-            return true;
-        }
-        if (digits.size() > other.digits.size())
-        {
-            return false;
-        }
-
-        // same digits
-        // positive
-        if (!is_negative)
-        {
-            for (size_t i = digits.size(); i > 0; i--)
-            {
-                // digit number smaller
-                if (digits[i - 1] < other.digits[i - 1])
-                {
-                    return true;
-                }
-                // digit number larger
-                if (digits[i - 1] > other.digits[i - 1])
-                {
-                    return false;
-                }
-            }
-        }
-        else
-        {
-            // negative, reserve the positive
-            for (size_t i = digits.size(); i > 0; i--)
-            {
-                if (digits[i - 1] > other.digits[i - 1])
-                {
-                    return true;
-                }
-                if (digits[i - 1] < other.digits[i - 1])
-                {
-                    return false;
-                }
-            }
-        }
-        // equal
-        return false;
+        return compare(other) < 0;
     }
 
     /**
@@ -489,7 +2204,7 @@ public:
      */
     bool operator<=(const bigint &other) const
     {
-        return *this < other || *this == other;
+        return compare(other) <= 0;
     }
 
     /**
@@ -576,14 +2291,45 @@ public:
      */
     friend std::ostream &operator<<(std::ostream &os, const bigint &value)
     {
-        if (value.is_negative)
-        {
-            os << '-';
-        }
-        for (size_t i = value.digits.size(); i > 0; i--)
+        // format into one buffer and hand it to the stream in a single call
+        std::string text = value.to_string();
+        os.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return os;
+    }
+};
+
+#if defined(__has_include)
+#if __has_include(<format>)
+#include <format>
+#endif
+#endif
+
+#ifdef __cpp_lib_format
+/**
+ * @brief std::format support for bigint.
+ *
+ * Accepts the specification documented in bigint::format_spec, e.g. std::format("{:*>+20,}", x)
+ * or std::format("{:#x}", x), and writes directly into the format context's output iterator.
+ */
+template <>
+struct std::formatter<bigint, char>
+{
+    bigint::format_spec spec;
+
+    constexpr auto parse(std::format_parse_context &ctx)
+    {
+        auto it = bigint::parse_format_spec(ctx.begin(), ctx.end(), spec);
+        if (it != ctx.end() && *it != '}')
         {
-            os << static_cast<int>(value.digits[i - 1]);
+            throw std::format_error("Invalid format specification for bigint");
         }
-        return os;
+        return it;
+    }
+
+    template <typename FormatContext>
+    auto format(const bigint &value, FormatContext &ctx) const
+    {
+        return value.format_to(ctx.out(), spec);
     }
 };
+#endif
@@ -0,0 +1,501 @@
+/**
+ * @file bigint_array.hpp
+ * @brief This file contains a flat container for many small bigints.
+ *
+ * A std::vector<bigint> gives every element its own heap-allocated digit vector. bigint_array
+ * instead stores the digits of all elements back to back in one arena, indexed by an offsets
+ * array and a sign array, so iterating over the elements walks memory sequentially.
+ *
+ * @version 1.0
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+#include "bigint.hpp"
+#include "bigint_sort.hpp"
+
+/**
+ * @class bigint_array
+ * @brief A sequence of bigints sharing one contiguous digit arena.
+ *
+ * Elements are read through const_reference views, which compare without copying and convert
+ * to bigint for arithmetic. Elements are appended, not modified in place.
+ */
+class bigint_array
+{
+private:
+    std::vector<uint8_t> arena;   // Digits of all elements, each least significant first
+    std::vector<size_t> offsets;  // Element i occupies arena[offsets[i], offsets[i + 1])
+    std::vector<uint8_t> signs;   // 1 if element i is negative
+
+    /**
+     * @brief Compares two magnitudes given as reverse-order digit ranges without leading zeros.
+     *
+     * @return Negative, zero or positive as the first magnitude is smaller, equal or larger.
+     */
+    static int compareMagnitude(const uint8_t *a, size_t aCount, const uint8_t *b, size_t bCount)
+    {
+        if (aCount != bCount)
+            return aCount < bCount ? -1 : 1;
+        for (size_t i = aCount; i > 0; i--)
+        {
+            if (a[i - 1] != b[i - 1])
+                return a[i - 1] < b[i - 1] ? -1 : 1;
+        }
+        return 0;
+    }
+
+    static void writeWord(std::ostream &os, uint64_t value)
+    {
+        char bytes[8];
+        for (int i = 0; i < 8; i++)
+            bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+        os.write(bytes, 8);
+    }
+
+    static uint64_t readWord(std::istream &is)
+    {
+        unsigned char bytes[8];
+        if (!is.read(reinterpret_cast<char *>(bytes), 8))
+            throw std::runtime_error("Truncated bigint_array data");
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++)
+            value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+        return value;
+    }
+
+public:
+    /**
+     * @class const_reference
+     * @brief A read-only view of one element.
+     */
+    class const_reference
+    {
+    private:
+        const bigint_array *array;
+        size_t index;
+
+        friend class bigint_array;
+
+        const uint8_t *data() const
+        {
+            return array->arena.data() + array->offsets[index];
+        }
+
+    public:
+        const_reference(const bigint_array &owner, size_t position) : array(&owner), index(position) {}
+
+        /**
+         * @brief Returns the number of decimal digits of the element.
+         */
+        size_t digit_count() const
+        {
+            return array->offsets[index + 1] - array->offsets[index];
+        }
+
+        /**
+         * @brief Returns whether the element is negative.
+         */
+        bool negative() const
+        {
+            return array->signs[index] != 0;
+        }
+
+        /**
+         * @brief Copies the element into a bigint.
+         */
+        bigint value() const
+        {
+            bigint result;
+            result.digits.assign(data(), data() + digit_count());
+            result.is_negative = negative();
+            return result;
+        }
+
+        /**
+         * @brief Converts the element to a bigint, so that views work with all bigint arithmetic.
+         */
+        operator bigint() const
+        {
+            return value();
+        }
+
+        /**
+         * @brief Three-way comparison of two elements, possibly of different arrays, without copying.
+         *
+         * @return Negative, zero or positive as this element is smaller, equal or larger.
+         */
+        int compare(const const_reference &other) const
+        {
+            if (negative() != other.negative())
+                return negative() ? -1 : 1;
+            int magnitude = compareMagnitude(data(), digit_count(), other.data(), other.digit_count());
+            return negative() ? -magnitude : magnitude;
+        }
+    };
+
+    /**
+     * @brief Creates an empty array.
+     */
+    bigint_array() : offsets{0} {}
+
+    /**
+     * @brief Returns the number of elements.
+     */
+    size_t size() const
+    {
+        return signs.size();
+    }
+
+    /**
+     * @brief Returns whether the array has no elements.
+     */
+    bool empty() const
+    {
+        return signs.empty();
+    }
+
+    /**
+     * @brief Returns the total number of digits stored in the arena.
+     */
+    size_t total_digits() const
+    {
+        return arena.size();
+    }
+
+    /**
+     * @brief Reserves room for a number of elements and digits.
+     *
+     * @param elements Expected number of elements.
+     * @param digits Expected total number of digits.
+     */
+    void reserve(size_t elements, size_t digits)
+    {
+        signs.reserve(elements);
+        offsets.reserve(elements + 1);
+        arena.reserve(digits);
+    }
+
+    /**
+     * @brief Returns a view of an element.
+     *
+     * @param index The element index, which must be less than size().
+     */
+    const_reference operator[](size_t index) const
+    {
+        return const_reference(*this, index);
+    }
+
+    /**
+     * @brief Returns a view of an element, checking the index.
+     *
+     * @param index The element index.
+     * @throws std::out_of_range If index is not less than size().
+     */
+    const_reference at(size_t index) const
+    {
+        if (index >= size())
+            throw std::out_of_range("bigint_array index out of range");
+        return const_reference(*this, index);
+    }
+
+    /**
+     * @brief Appends a bigint.
+     *
+     * @param value The value to append.
+     */
+    void push_back(const bigint &value)
+    {
+        arena.insert(arena.end(), value.digits.begin(), value.digits.end());
+        offsets.push_back(arena.size());
+        signs.push_back(value.is_negative ? 1 : 0);
+    }
+
+    /**
+     * @brief Appends an element of another (or the same) array without going through a bigint.
+     *
+     * @param value The element to append.
+     */
+    void push_back(const const_reference &value)
+    {
+        const bigint_array *source = value.array;
+        size_t begin = source->offsets[value.index];
+        size_t count = value.digit_count();
+        bool negative = value.negative();
+        // copy by position: the source may be this array, whose arena moves when it grows
+        size_t end = arena.size();
+        arena.resize(end + count);
+        std::copy_n(source->arena.data() + begin, count, arena.data() + end);
+        offsets.push_back(arena.size());
+        signs.push_back(negative ? 1 : 0);
+    }
+
+    /**
+     * @brief Appends a range of bigints, growing the arena once.
+     *
+     * @param first Iterator to the first bigint.
+     * @param last Iterator past the last bigint.
+     */
+    template <typename Iterator>
+    void append(Iterator first, Iterator last)
+    {
+        size_t digits = 0;
+        size_t count = 0;
+        for (Iterator it = first; it != last; ++it, ++count)
+        {
+            digits += static_cast<const bigint &>(*it).digit_count();
+        }
+        reserve(size() + count, arena.size() + digits);
+        for (; first != last; ++first)
+        {
+            push_back(static_cast<const bigint &>(*first));
+        }
+    }
+
+    /**
+     * @brief Appends all elements of another array with one copy of its arena.
+     *
+     * @param other The array to append.
+     */
+    void append(const bigint_array &other)
+    {
+        if (&other == this)
+        {
+            bigint_array copy(other);
+            append(copy);
+            return;
+        }
+        size_t base = arena.size();
+        arena.insert(arena.end(), other.arena.begin(), other.arena.end());
+        for (size_t i = 1; i < other.offsets.size(); i++)
+        {
+            offsets.push_back(base + other.offsets[i]);
+        }
+        signs.insert(signs.end(), other.signs.begin(), other.signs.end());
+    }
+
+    /**
+     * @brief Removes all elements.
+     */
+    void clear()
+    {
+        arena.clear();
+        offsets.assign(1, 0);
+        signs.clear();
+    }
+
+    /**
+     * @brief Sorts the elements in ascending order and compacts the arena in the new order.
+     *
+     * Uses the key radix sort of bigint_sorter: elements are only compared digit by digit when
+     * they agree in sign, length and leading 19 digits.
+     *
+     * @param threads Number of threads to use, 0 for bigint::max_threads().
+     */
+    void sort(unsigned threads = 1)
+    {
+        std::vector<bigint_sorter::key> keys(size());
+        for (size_t i = 0; i < size(); i++)
+        {
+            const_reference element = (*this)[i];
+            size_t count = element.digit_count();
+            const uint8_t *top = element.data() + count;
+            uint64_t leading = 0;
+            for (size_t k = 0; k < std::min(count, bigint_sorter::prefix_digits); k++)
+            {
+                leading = leading * 10 + *--top;
+            }
+            keys[i] = bigint_sorter::make_key(element.negative(), count, leading, i);
+        }
+        std::vector<size_t> order = bigint_sorter::order(
+            keys, [this](size_t i)
+            { return (*this)[i].digit_count(); },
+            [this](size_t a, size_t b)
+            { return (*this)[a].compare((*this)[b]) < 0; },
+            threads == 0 ? bigint::max_threads() : threads);
+        permute(order);
+    }
+
+    /**
+     * @brief Rearranges the elements so that element i becomes the old element order[i].
+     *
+     * @param order A permutation of 0 .. size() - 1.
+     */
+    void permute(const std::vector<size_t> &order)
+    {
+        bigint_array sorted;
+        sorted.reserve(size(), arena.size());
+        for (size_t index : order)
+        {
+            sorted.push_back((*this)[index]);
+        }
+        *this = std::move(sorted);
+    }
+
+    /**
+     * @brief Writes the array in a portable binary format.
+     *
+     * Layout: element count and digit count as 64-bit little-endian words, the element lengths
+     * as 64-bit words, one sign byte per element, then the arena packed two digits per byte.
+     *
+     * @param os The output stream.
+     */
+    void write(std::ostream &os) const
+    {
+        os.write("BIGARRAY", 8);
+        writeWord(os, size());
+        writeWord(os, arena.size());
+        for (size_t i = 0; i < size(); i++)
+        {
+            writeWord(os, offsets[i + 1] - offsets[i]);
+        }
+        os.write(reinterpret_cast<const char *>(signs.data()), static_cast<std::streamsize>(signs.size()));
+        std::vector<char> packed((arena.size() + 1) / 2, 0);
+        for (size_t i = 0; i < arena.size(); i++)
+        {
+            packed[i / 2] = static_cast<char>(packed[i / 2] | (arena[i] << (4 * (i % 2))));
+        }
+        os.write(packed.data(), static_cast<std::streamsize>(packed.size()));
+    }
+
+    /**
+     * @brief Reads an array written by write().
+     *
+     * @param is The input stream.
+     * @return The array.
+     * @throws std::runtime_error If the data is truncated or malformed.
+     */
+    static bigint_array read(std::istream &is)
+    {
+        char magic[8];
+        if (!is.read(magic, 8) || std::string(magic, 8) != "BIGARRAY")
+            throw std::runtime_error("Not bigint_array data");
+        uint64_t count = readWord(is);
+        uint64_t digits = readWord(is);
+
+        bigint_array result;
+        result.offsets.reserve(count + 1);
+        for (uint64_t i = 0; i < count; i++)
+        {
+            uint64_t length = readWord(is);
+            if (length == 0 || length > digits - result.offsets.back())
+                throw std::runtime_error("Malformed bigint_array data");
+            result.offsets.push_back(result.offsets.back() + length);
+        }
+        if (result.offsets.back() != digits)
+            throw std::runtime_error("Malformed bigint_array data");
+        result.signs.resize(count);
+        std::vector<char> packed((digits + 1) / 2);
+        if (!is.read(reinterpret_cast<char *>(result.signs.data()), static_cast<std::streamsize>(count)) ||
+            !is.read(packed.data(), static_cast<std::streamsize>(packed.size())))
+            throw std::runtime_error("Truncated bigint_array data");
+        result.arena.resize(digits);
+        for (size_t i = 0; i < digits; i++)
+        {
+            uint8_t digit = static_cast<uint8_t>((static_cast<uint8_t>(packed[i / 2]) >> (4 * (i % 2))) & 0x0F);
+            if (digit > 9)
+                throw std::runtime_error("Malformed bigint_array data");
+            result.arena[i] = digit;
+        }
+        return result;
+    }
+};
+
+/**
+ * @brief Arithmetic and comparison with an element view on the left.
+ *
+ * With a bigint on the left the member operators of bigint apply, converting the view.
+ */
+inline bigint operator+(const bigint_array::const_reference &lhs, const bigint &rhs)
+{
+    return lhs.value() + rhs;
+}
+
+inline bigint operator-(const bigint_array::const_reference &lhs, const bigint &rhs)
+{
+    return lhs.value() - rhs;
+}
+
+inline bigint operator*(const bigint_array::const_reference &lhs, const bigint &rhs)
+{
+    return lhs.value() * rhs;
+}
+
+inline bigint operator-(const bigint_array::const_reference &value)
+{
+    return -value.value();
+}
+
+inline bool operator==(const bigint_array::const_reference &lhs, const bigint_array::const_reference &rhs)
+{
+    return lhs.compare(rhs) == 0;
+}
+
+inline bool operator!=(const bigint_array::const_reference &lhs, const bigint_array::const_reference &rhs)
+{
+    return lhs.compare(rhs) != 0;
+}
+
+inline bool operator<(const bigint_array::const_reference &lhs, const bigint_array::const_reference &rhs)
+{
+    return lhs.compare(rhs) < 0;
+}
+
+inline bool operator<=(const bigint_array::const_reference &lhs, const bigint_array::const_reference &rhs)
+{
+    return lhs.compare(rhs) <= 0;
+}
+
+inline bool operator>(const bigint_array::const_reference &lhs, const bigint_array::const_reference &rhs)
+{
+    return lhs.compare(rhs) > 0;
+}
+
+inline bool operator>=(const bigint_array::const_reference &lhs, const bigint_array::const_reference &rhs)
+{
+    return lhs.compare(rhs) >= 0;
+}
+
+inline bool operator==(const bigint_array::const_reference &lhs, const bigint &rhs)
+{
+    return lhs.value() == rhs;
+}
+
+inline bool operator!=(const bigint_array::const_reference &lhs, const bigint &rhs)
+{
+    return lhs.value() != rhs;
+}
+
+inline bool operator<(const bigint_array::const_reference &lhs, const bigint &rhs)
+{
+    return lhs.value() < rhs;
+}
+
+inline bool operator<=(const bigint_array::const_reference &lhs, const bigint &rhs)
+{
+    return lhs.value() <= rhs;
+}
+
+inline bool operator>(const bigint_array::const_reference &lhs, const bigint &rhs)
+{
+    return lhs.value() > rhs;
+}
+
+inline bool operator>=(const bigint_array::const_reference &lhs, const bigint &rhs)
+{
+    return lhs.value() >= rhs;
+}
+
+/**
+ * @brief Prints an element view.
+ */
+inline std::ostream &operator<<(std::ostream &os, const bigint_array::const_reference &value)
+{
+    return os << value.value();
+}
@@ -0,0 +1,330 @@
+/**
+ * @file bigint_histogram.hpp
+ * @brief This file contains latency histograms of bigint operations, per operation and operand size class.
+ *
+ * Latencies are counted in log-linear buckets, as in HDR histograms: every power of two of
+ * nanoseconds is split into 8 equal sub-buckets, which bounds the relative error of a reported
+ * percentile to 12.5% over the whole range from 1 ns to about 18 minutes.
+ *
+ * Each thread counts into its own block of counters, which only that thread writes, so recording
+ * never takes a lock or a contended cache line. Reading merges all blocks.
+ *
+ * @version 1.0
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "bigint.hpp"
+
+/**
+ * @class bigint_latency_histogram
+ * @brief Records the duration of every top-level bigint operation while it is alive.
+ *
+ * Operations are grouped by type and by size class, the size class being floor(log2) of the digit
+ * count of the larger operand. Results can be exported as JSON or in the Prometheus text format.
+ */
+class bigint_latency_histogram : public bigint_observer
+{
+public:
+    static constexpr unsigned sub_bucket_bits = 3;  // 2^3 sub-buckets per power of two
+    static constexpr unsigned max_shift = 37;       // Largest value tracked is about 2^40 ns
+    static constexpr size_t bucket_count = (size_t(1) << sub_bucket_bits) * (max_shift + 2);
+    static constexpr size_t size_class_count = 24;  // Last class holds everything from 2^23 digits
+
+    /**
+     * @brief Returns the bucket a latency falls into.
+     *
+     * @param nanoseconds The latency.
+     * @return The bucket index.
+     */
+    static size_t bucket_index(uint64_t nanoseconds)
+    {
+        const uint64_t subCount = uint64_t(1) << sub_bucket_bits;
+        if (nanoseconds < subCount)
+            return static_cast<size_t>(nanoseconds);
+        unsigned msb = 63;
+        while ((nanoseconds >> msb) == 0)
+            msb--;
+        unsigned shift = msb - sub_bucket_bits;
+        if (shift > max_shift)
+            return bucket_count - 1;
+        return static_cast<size_t>(subCount * (shift + 1) + ((nanoseconds >> shift) - subCount));
+    }
+
+    /**
+     * @brief Returns the largest latency that falls into a bucket.
+     *
+     * @param bucket The bucket index.
+     * @return The inclusive upper bound in nanoseconds.
+     */
+    static uint64_t bucket_upper_bound(size_t bucket)
+    {
+        const uint64_t subCount = uint64_t(1) << sub_bucket_bits;
+        if (bucket < subCount)
+            return bucket;
+        uint64_t shift = bucket / subCount - 1;
+        uint64_t top = subCount + bucket % subCount;
+        return ((top + 1) << shift) - 1;
+    }
+
+    /**
+     * @brief Returns the size class of an operation.
+     *
+     * @param digits Digit count of the larger operand.
+     * @return floor(log2(digits)), capped to the last class.
+     */
+    static size_t size_class(size_t digits)
+    {
+        size_t sizeClass = 0;
+        while (digits > 1 && sizeClass + 1 < size_class_count)
+        {
+            digits >>= 1;
+            sizeClass++;
+        }
+        return sizeClass;
+    }
+
+    /**
+     * @brief Merged counts of one operation type and size class.
+     */
+    struct series
+    {
+        bigint_op op;
+        size_t size_class;
+        uint64_t count = 0;
+        uint64_t sum_ns = 0;
+        std::vector<uint64_t> buckets = std::vector<uint64_t>(bucket_count, 0);
+
+        /**
+         * @brief Returns an upper bound of the q-quantile of the latencies.
+         *
+         * @param q The quantile, in [0, 1].
+         * @return The upper bound of the bucket holding the quantile, in nanoseconds.
+         */
+        uint64_t percentile(double q) const
+        {
+            uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count));
+            rank = std::min<uint64_t>(std::max<uint64_t>(rank, 1), count);
+            uint64_t seen = 0;
+            for (size_t b = 0; b < bucket_count; b++)
+            {
+                seen += buckets[b];
+                if (seen >= rank)
+                    return bucket_upper_bound(b);
+            }
+            return 0;
+        }
+    };
+
+private:
+    static constexpr size_t seriesCount = bigint_op_count * size_class_count;
+
+    /**
+     * @brief The counters of one thread. Only that thread writes them; readers load them.
+     */
+    struct threadBlock
+    {
+        std::atomic<uint64_t> counts[seriesCount][bucket_count] = {};
+        std::atomic<uint64_t> sums[seriesCount] = {};
+    };
+
+    uint64_t id; // Unique across all histograms, used to find this histogram's thread block
+    std::mutex blocks_mutex;
+    std::vector<std::unique_ptr<threadBlock>> blocks;
+
+    static uint64_t nextId()
+    {
+        static std::atomic<uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Returns the calling thread's block, creating it on the thread's first operation.
+     */
+    threadBlock &localBlock()
+    {
+        thread_local std::vector<std::pair<uint64_t, threadBlock *>> cache;
+        for (const std::pair<uint64_t, threadBlock *> &entry : cache)
+        {
+            if (entry.first == id)
+                return *entry.second;
+        }
+        std::unique_ptr<threadBlock> block(new threadBlock());
+        threadBlock *pointer = block.get();
+        {
+            std::lock_guard<std::mutex> lock(blocks_mutex);
+            blocks.push_back(std::move(block));
+        }
+        cache.emplace_back(id, pointer);
+        return *pointer;
+    }
+
+    static void bump(std::atomic<uint64_t> &counter, uint64_t amount)
+    {
+        // single writer, a plain load and store is enough
+        counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Formats a nanosecond value as seconds for Prometheus.
+     */
+    static std::string seconds(uint64_t nanoseconds)
+    {
+        std::ostringstream os;
+        os.precision(12);
+        os << static_cast<double>(nanoseconds) / 1e9;
+        return os.str();
+    }
+
+    static std::string sizeLabel(size_t sizeClass)
+    {
+        std::string low = std::to_string(size_t(1) << sizeClass);
+        if (sizeClass + 1 == size_class_count)
+            return low + "+";
+        return low + "-" + std::to_string((size_t(2) << sizeClass) - 1);
+    }
+
+public:
+    /**
+     * @brief Creates an empty histogram and starts recording.
+     *
+     * @throws std::runtime_error If all observer slots are taken.
+     */
+    bigint_latency_histogram() : id(nextId())
+    {
+        if (!bigint::add_observer(this))
+            throw std::runtime_error("Too many bigint observers");
+    }
+
+    /**
+     * @brief Stops recording.
+     */
+    ~bigint_latency_histogram() override
+    {
+        bigint::remove_observer(this);
+    }
+
+    bigint_latency_histogram(const bigint_latency_histogram &) = delete;
+    bigint_latency_histogram &operator=(const bigint_latency_histogram &) = delete;
+
+    void after(bigint_op op, size_t lhsDigits, size_t rhsDigits, uint64_t nanoseconds) override
+    {
+        size_t index = static_cast<size_t>(op) * size_class_count + size_class(std::max(lhsDigits, rhsDigits));
+        threadBlock &block = localBlock();
+        bump(block.counts[index][bucket_index(nanoseconds)], 1);
+        bump(block.sums[index], nanoseconds);
+    }
+
+    /**
+     * @brief Merges the counters of all threads.
+     *
+     * @return One entry per operation type and size class that has recorded operations.
+     */
+    std::vector<series> snapshot()
+    {
+        std::vector<series> merged(seriesCount);
+        for (size_t i = 0; i < seriesCount; i++)
+        {
+            merged[i].op = static_cast<bigint_op>(i / size_class_count);
+            merged[i].size_class = i % size_class_count;
+        }
+        {
+            std::lock_guard<std::mutex> lock(blocks_mutex);
+            for (const std::unique_ptr<threadBlock> &block : blocks)
+            {
+                for (size_t i = 0; i < seriesCount; i++)
+                {
+                    merged[i].sum_ns += block->sums[i].load(std::memory_order_relaxed);
+                    for (size_t b = 0; b < bucket_count; b++)
+                    {
+                        uint64_t count = block->counts[i][b].load(std::memory_order_relaxed);
+                        merged[i].buckets[b] += count;
+                        merged[i].count += count;
+                    }
+                }
+            }
+        }
+        merged.erase(std::remove_if(merged.begin(), merged.end(), [](const series &s)
+                                    { return s.count == 0; }),
+                     merged.end());
+        return merged;
+    }
+
+    /**
+     * @brief Exports the histogram as JSON.
+     *
+     * Every series lists its operation, digit range, count, total time, a few percentiles and its
+     * non-empty buckets as [upper bound in ns, count] pairs.
+     *
+     * @return The JSON document.
+     */
+    std::string to_json()
+    {
+        std::ostringstream os;
+        os << "{\"series\":[";
+        bool first = true;
+        for (const series &s : snapshot())
+        {
+            os << (first ? "" : ",") << "{\"op\":\"" << bigint_op_name(s.op) << "\",\"digits\":\"" << sizeLabel(s.size_class)
+               << "\",\"count\":" << s.count << ",\"sum_ns\":" << s.sum_ns << ",\"p50_ns\":" << s.percentile(0.5)
+               << ",\"p90_ns\":" << s.percentile(0.9) << ",\"p99_ns\":" << s.percentile(0.99)
+               << ",\"p999_ns\":" << s.percentile(0.999) << ",\"buckets\":[";
+            bool firstBucket = true;
+            for (size_t b = 0; b < bucket_count; b++)
+            {
+                if (s.buckets[b] == 0)
+                    continue;
+                os << (firstBucket ? "" : ",") << "[" << bucket_upper_bound(b) << "," << s.buckets[b] << "]";
+                firstBucket = false;
+            }
+            os << "]}";
+            first = false;
+        }
+        os << "]}";
+        return os.str();
+    }
+
+    /**
+     * @brief Exports the histogram in the Prometheus text exposition format.
+     *
+     * Emits one histogram metric labelled by op and digits, with cumulative buckets at the upper
+     * bounds of the non-empty buckets.
+     *
+     * @param name The metric name.
+     * @return The exposition text.
+     */
+    std::string to_prometheus(const std::string &name = "bigint_operation_duration_seconds")
+    {
+        std::ostringstream os;
+        os << "# HELP " << name << " Latency of bigint operations by operand size.\n";
+        os << "# TYPE " << name << " histogram\n";
+        for (const series &s : snapshot())
+        {
+            std::string labels = "op=\"" + std::string(bigint_op_name(s.op)) + "\",digits=\"" + sizeLabel(s.size_class) + "\"";
+            uint64_t cumulative = 0;
+            for (size_t b = 0; b < bucket_count; b++)
+            {
+                if (s.buckets[b] == 0)
+                    continue;
+                cumulative += s.buckets[b];
+                // bucket b holds latencies up to its upper bound, inclusive
+                os << name << "_bucket{" << labels << ",le=\"" << seconds(bucket_upper_bound(b)) << "\"} " << cumulative << "\n";
+            }
+            os << name << "_bucket{" << labels << ",le=\"+Inf\"} " << s.count << "\n";
+            os << name << "_sum{" << labels << "} " << seconds(s.sum_ns) << "\n";
+            os << name << "_count{" << labels << "} " << s.count << "\n";
+        }
+        return os.str();
+    }
+};
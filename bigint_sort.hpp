@@ -0,0 +1,302 @@
+/**
+ * @file bigint_sort.hpp
+ * @brief This file contains a cache-friendly sort for large arrays of bigints.
+ *
+ * Sorting with std::sort and operator< chases every element's digit pointer on each comparison.
+ * sort_bigints instead builds one compact key per element: a group word ordering by sign and
+ * digit count, and the leading 19 digits. The keys are radix-sorted in a few sequential passes,
+ * and only elements whose keys tie (same sign, length and 19 leading digits) are compared in full.
+ *
+ * @version 1.0
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "bigint.hpp"
+
+/**
+ * @class bigint_sorter
+ * @brief The key building and sorting steps shared by sort_bigints and bigint_array.
+ */
+class bigint_sorter
+{
+public:
+    static constexpr size_t prefix_digits = 19;
+
+    /**
+     * @brief The sort key of one element.
+     */
+    struct key
+    {
+        uint64_t group;  // Orders by sign, then by digit count (reversed for negative numbers)
+        uint64_t prefix; // Leading digits (complemented for negative numbers)
+        size_t index;    // Position of the element in the input
+    };
+
+    /**
+     * @brief Builds the key of an element.
+     *
+     * @param negative Whether the element is negative.
+     * @param digitCount Number of digits of the element.
+     * @param leading The first min(19, digitCount) digits as an integer.
+     * @param index Position of the element.
+     */
+    static key make_key(bool negative, size_t digitCount, uint64_t leading, size_t index)
+    {
+        const uint64_t limit = 10000000000000000000ULL; // 10^19
+        // left-align short numbers; within a group all numbers have the same length anyway
+        for (size_t i = digitCount; i < prefix_digits; i++)
+        {
+            leading *= 10;
+        }
+        const uint64_t signBit = uint64_t(1) << 63;
+        if (negative)
+        {
+            return key{signBit - 1 - digitCount, limit - 1 - leading, index};
+        }
+        return key{signBit + digitCount, leading, index};
+    }
+
+    /**
+     * @brief Sorts keys by (group, prefix) with an LSD radix sort on bytes.
+     *
+     * Passes in which all keys share the same byte are skipped, which drops most passes over the
+     * group word.
+     *
+     * @param keys The keys, sorted in place. The sort is stable.
+     */
+    static void radix_sort(std::vector<key> &keys)
+    {
+        std::vector<key> buffer(keys.size());
+        for (int pass = 0; pass < 16; pass++)
+        {
+            bool groupWord = pass >= 8;
+            unsigned shift = 8 * (pass % 8);
+            size_t counts[256] = {};
+            for (const key &k : keys)
+            {
+                counts[((groupWord ? k.group : k.prefix) >> shift) & 0xFF]++;
+            }
+            if (std::find(std::begin(counts), std::end(counts), keys.size()) != std::end(counts))
+            {
+                continue;
+            }
+            size_t offset = 0;
+            for (size_t &count : counts)
+            {
+                size_t c = count;
+                count = offset;
+                offset += c;
+            }
+            for (const key &k : keys)
+            {
+                buffer[counts[((groupWord ? k.group : k.prefix) >> shift) & 0xFF]++] = k;
+            }
+            keys.swap(buffer);
+        }
+    }
+
+    /**
+     * @brief Returns whether two keys order the same, i.e. their elements may only differ after the prefix.
+     */
+    static bool tie(const key &a, const key &b)
+    {
+        return a.group == b.group && a.prefix == b.prefix;
+    }
+
+    static bool keyLess(const key &a, const key &b)
+    {
+        return a.group != b.group ? a.group < b.group : a.prefix < b.prefix;
+    }
+
+    /**
+     * @brief Sorts the keys and resolves ties with a full comparison.
+     *
+     * @param keys The keys of all elements.
+     * @param digitCount Returns the digit count of an element by index.
+     * @param less Full comparison of two elements by index.
+     * @param threads Number of threads to use.
+     * @return The element indexes in ascending order.
+     */
+    template <typename DigitCount, typename Less>
+    static std::vector<size_t> order(std::vector<key> &keys, const DigitCount &digitCount, const Less &less, unsigned threads)
+    {
+        size_t n = keys.size();
+        threads = static_cast<unsigned>(std::max<size_t>(1, std::min<size_t>(threads, n / 4096)));
+        if (threads <= 1)
+        {
+            radix_sort(keys);
+        }
+        else
+        {
+            // radix-sort one chunk per thread, then merge chunks pairwise in parallel rounds
+            std::vector<size_t> bounds(threads + 1);
+            for (unsigned t = 0; t <= threads; t++)
+            {
+                bounds[t] = n * t / threads;
+            }
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; t++)
+            {
+                workers.emplace_back([&, t]()
+                                     {
+                    std::vector<key> chunk(keys.begin() + bounds[t], keys.begin() + bounds[t + 1]);
+                    radix_sort(chunk);
+                    std::copy(chunk.begin(), chunk.end(), keys.begin() + bounds[t]); });
+            }
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+            for (size_t width = 1; width < threads; width *= 2)
+            {
+                workers.clear();
+                for (size_t t = 0; t + width < threads; t += 2 * width)
+                {
+                    size_t begin = bounds[t];
+                    size_t mid = bounds[t + width];
+                    size_t end = bounds[std::min<size_t>(t + 2 * width, threads)];
+                    workers.emplace_back([&keys, begin, mid, end]()
+                                         { std::inplace_merge(keys.begin() + begin, keys.begin() + mid, keys.begin() + end, keyLess); });
+                }
+                for (std::thread &worker : workers)
+                {
+                    worker.join();
+                }
+            }
+        }
+
+        // runs of tied keys longer than the prefix need the full comparison
+        std::vector<std::pair<size_t, size_t>> runs;
+        for (size_t i = 0; i < n;)
+        {
+            size_t j = i + 1;
+            while (j < n && tie(keys[i], keys[j]))
+            {
+                j++;
+            }
+            if (j - i > 1 && digitCount(keys[i].index) > prefix_digits)
+            {
+                runs.emplace_back(i, j);
+            }
+            i = j;
+        }
+        auto resolve = [&](size_t first, size_t last)
+        {
+            for (size_t r = first; r < last; r++)
+            {
+                std::stable_sort(keys.begin() + runs[r].first, keys.begin() + runs[r].second, [&](const key &a, const key &b)
+                                 { return less(a.index, b.index); });
+            }
+        };
+        if (threads <= 1 || runs.size() < 2)
+        {
+            resolve(0, runs.size());
+        }
+        else
+        {
+            std::vector<std::thread> workers;
+            for (unsigned t = 0; t < threads; t++)
+            {
+                workers.emplace_back(resolve, runs.size() * t / threads, runs.size() * (t + 1) / threads);
+            }
+            for (std::thread &worker : workers)
+            {
+                worker.join();
+            }
+        }
+
+        std::vector<size_t> result(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            result[i] = keys[i].index;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Sorts a random-access range of bigints using the given number of threads.
+     */
+    template <typename RandomIt>
+    static void sort(RandomIt first, RandomIt last, unsigned threads)
+    {
+        size_t n = static_cast<size_t>(last - first);
+        std::vector<key> keys(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            const bigint &value = first[i];
+            keys[i] = make_key(value.negative(), value.digit_count(), value.top_digits(prefix_digits), i);
+        }
+        std::vector<size_t> sorted = order(
+            keys, [&](size_t i)
+            { return static_cast<const bigint &>(first[i]).digit_count(); },
+            [&](size_t i, size_t j)
+            { return first[i] < first[j]; },
+            threads);
+
+        std::vector<bigint> values;
+        values.reserve(n);
+        for (size_t index : sorted)
+        {
+            values.push_back(std::move(first[index]));
+        }
+        std::move(values.begin(), values.end(), first);
+    }
+};
+
+/**
+ * @brief Sorts a range of bigints in ascending order.
+ *
+ * The sort is stable.
+ *
+ * @param first Random-access iterator to the first bigint.
+ * @param last Random-access iterator past the last bigint.
+ */
+template <typename RandomIt>
+void sort_bigints(RandomIt first, RandomIt last)
+{
+    bigint_sorter::sort(first, last, 1);
+}
+
+/**
+ * @brief Sorts a container of bigints, such as std::vector<bigint>, in ascending order.
+ *
+ * @param range The container.
+ */
+template <typename Range>
+void sort_bigints(Range &range)
+{
+    sort_bigints(std::begin(range), std::end(range));
+}
+
+/**
+ * @brief Sorts a range of bigints in ascending order on up to bigint::max_threads() threads.
+ *
+ * Chunks are radix-sorted in parallel and merged pairwise, then ties are resolved in parallel.
+ *
+ * @param first Random-access iterator to the first bigint.
+ * @param last Random-access iterator past the last bigint.
+ */
+template <typename RandomIt>
+void sort_bigints_parallel(RandomIt first, RandomIt last)
+{
+    bigint_sorter::sort(first, last, bigint::max_threads());
+}
+
+/**
+ * @brief Sorts a container of bigints in ascending order on up to bigint::max_threads() threads.
+ *
+ * @param range The container.
+ */
+template <typename Range>
+void sort_bigints_parallel(Range &range)
+{
+    sort_bigints_parallel(std::begin(range), std::end(range));
+}
@@ -0,0 +1,280 @@
+/**
+ * @file bigint_trace.hpp
+ * @brief This file contains a recorder that logs bigint operations to a binary trace file, and a reader for it.
+ *
+ * A trace captures the real mix of operations and operand sizes of a program, so that it can be
+ * replayed offline (see replay.cpp) to evaluate optimizations against real traffic.
+ *
+ * File layout: the magic "BIGTRACE", a version byte and a flags byte (bit 0: operand values
+ * recorded), followed by one record per operation:
+ *   - op (1 byte) and flags (1 byte: bit 0 lhs negative, bit 1 has rhs, bit 2 rhs negative)
+ *   - thread index, lhs digit count and, if present, rhs digit count as LEB128 varints
+ *   - if values are recorded, the lhs and rhs digits packed two per byte, most significant first
+ *
+ * @version 1.0
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "bigint.hpp"
+
+/**
+ * @brief One operation read back from a trace.
+ */
+struct bigint_trace_record
+{
+    bigint_op op = bigint_op::add;
+    uint32_t thread = 0;         // Index of the recording thread, in order of first operation
+    size_t lhs_digits = 0;       // Digit count of the left operand
+    size_t rhs_digits = 0;       // Digit count of the right operand, 0 if there is none
+    bool has_rhs = false;        // Whether the operation has a right operand
+    bool lhs_negative = false;   // Sign of the left operand
+    bool rhs_negative = false;   // Sign of the right operand
+    std::string lhs_value;       // Decimal magnitude of the left operand, empty if values were not recorded
+    std::string rhs_value;       // Decimal magnitude of the right operand, empty if values were not recorded
+};
+
+/**
+ * @class bigint_trace_recorder
+ * @brief Records every top-level bigint operation to a trace file while it is alive.
+ *
+ * Recording is opt-in: operations are only logged between construction and destruction of a
+ * recorder. Records from all threads are appended to one buffer under a mutex and written out
+ * in large blocks.
+ */
+class bigint_trace_recorder : public bigint_observer
+{
+private:
+    std::ofstream file;
+    bool record_values;
+    std::mutex buffer_mutex; // Guards buffer and file
+    std::vector<char> buffer;
+
+    static constexpr size_t flushSize = size_t(1) << 20;
+
+    /**
+     * @brief Returns a small integer identifying the calling thread.
+     */
+    static uint32_t threadIndex()
+    {
+        static std::atomic<uint32_t> next{0};
+        thread_local uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    static void putVarint(std::vector<char> &out, uint64_t value)
+    {
+        while (value >= 0x80)
+        {
+            out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<char>(value));
+    }
+
+    /**
+     * @brief Appends the digits of a number packed two per byte, most significant first.
+     */
+    static void putDigits(std::vector<char> &out, const bigint &value)
+    {
+        std::string text = value.to_string();
+        size_t start = value.negative() ? 1 : 0;
+        for (size_t i = start; i < text.size(); i += 2)
+        {
+            uint8_t high = static_cast<uint8_t>(text[i] - '0');
+            uint8_t low = i + 1 < text.size() ? static_cast<uint8_t>(text[i + 1] - '0') : 0;
+            out.push_back(static_cast<char>((high << 4) | low));
+        }
+    }
+
+    void flushLocked()
+    {
+        file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+public:
+    /**
+     * @brief Opens a trace file and starts recording.
+     *
+     * @param path The trace file to create.
+     * @param values Whether to record operand values in addition to their sizes.
+     * @throws std::runtime_error If the file cannot be opened or all observer slots are taken.
+     */
+    bigint_trace_recorder(const std::string &path, bool values = false)
+        : file(path, std::ios::binary | std::ios::trunc), record_values(values)
+    {
+        if (!file)
+            throw std::runtime_error("Cannot open trace file");
+        file.write("BIGTRACE", 8);
+        char header[2] = {1, static_cast<char>(record_values ? 1 : 0)};
+        file.write(header, 2);
+        if (!bigint::add_observer(this))
+            throw std::runtime_error("Too many bigint observers");
+    }
+
+    /**
+     * @brief Stops recording and writes the remaining records.
+     */
+    ~bigint_trace_recorder() override
+    {
+        bigint::remove_observer(this);
+        flush();
+    }
+
+    bigint_trace_recorder(const bigint_trace_recorder &) = delete;
+    bigint_trace_recorder &operator=(const bigint_trace_recorder &) = delete;
+
+    /**
+     * @brief Writes buffered records to the file.
+     */
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        flushLocked();
+        file.flush();
+    }
+
+    void before(bigint_op op, const bigint &lhs, const bigint *rhs) override
+    {
+        std::vector<char> record;
+        record.push_back(static_cast<char>(op));
+        uint8_t flags = (lhs.negative() ? 1 : 0) | (rhs != nullptr ? 2 : 0) | (rhs != nullptr && rhs->negative() ? 4 : 0);
+        record.push_back(static_cast<char>(flags));
+        putVarint(record, threadIndex());
+        putVarint(record, lhs.digit_count());
+        if (rhs != nullptr)
+        {
+            putVarint(record, rhs->digit_count());
+        }
+        if (record_values)
+        {
+            putDigits(record, lhs);
+            if (rhs != nullptr)
+            {
+                putDigits(record, *rhs);
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        buffer.insert(buffer.end(), record.begin(), record.end());
+        if (buffer.size() >= flushSize)
+        {
+            flushLocked();
+        }
+    }
+};
+
+/**
+ * @class bigint_trace_reader
+ * @brief Reads the records of a trace file written by bigint_trace_recorder.
+ */
+class bigint_trace_reader
+{
+private:
+    std::ifstream file;
+    bool has_values;
+
+    bool getByte(uint8_t &byte)
+    {
+        char c;
+        if (!file.get(c))
+            return false;
+        byte = static_cast<uint8_t>(c);
+        return true;
+    }
+
+    uint64_t getVarint()
+    {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            uint8_t byte;
+            if (!getByte(byte))
+                throw std::runtime_error("Truncated trace file");
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        throw std::runtime_error("Corrupt trace file");
+    }
+
+    std::string getDigits(size_t count)
+    {
+        std::string text(count, '0');
+        for (size_t i = 0; i < count; i += 2)
+        {
+            uint8_t byte;
+            if (!getByte(byte))
+                throw std::runtime_error("Truncated trace file");
+            text[i] = static_cast<char>('0' + (byte >> 4));
+            if (i + 1 < count)
+                text[i + 1] = static_cast<char>('0' + (byte & 0x0F));
+        }
+        return text;
+    }
+
+public:
+    /**
+     * @brief Opens a trace file and checks its header.
+     *
+     * @param path The trace file.
+     * @throws std::runtime_error If the file cannot be opened or is not a trace.
+     */
+    explicit bigint_trace_reader(const std::string &path) : file(path, std::ios::binary), has_values(false)
+    {
+        char header[10];
+        if (!file.read(header, 10) || std::string(header, 8) != "BIGTRACE" || header[8] != 1)
+            throw std::runtime_error("Not a bigint trace file");
+        has_values = (header[9] & 1) != 0;
+    }
+
+    /**
+     * @brief Returns whether the trace contains operand values.
+     */
+    bool values_recorded() const
+    {
+        return has_values;
+    }
+
+    /**
+     * @brief Reads the next record.
+     *
+     * @param record Receives the record.
+     * @return False at the end of the trace.
+     * @throws std::runtime_error If the trace is truncated.
+     */
+    bool next(bigint_trace_record &record)
+    {
+        uint8_t op;
+        if (!getByte(op))
+            return false;
+        uint8_t flags;
+        if (!getByte(flags))
+            throw std::runtime_error("Truncated trace file");
+        record.op = static_cast<bigint_op>(op);
+        record.lhs_negative = (flags & 1) != 0;
+        record.has_rhs = (flags & 2) != 0;
+        record.rhs_negative = (flags & 4) != 0;
+        record.thread = static_cast<uint32_t>(getVarint());
+        record.lhs_digits = getVarint();
+        record.rhs_digits = record.has_rhs ? getVarint() : 0;
+        record.lhs_value.clear();
+        record.rhs_value.clear();
+        if (has_values)
+        {
+            record.lhs_value = getDigits(record.lhs_digits);
+            if (record.has_rhs)
+                record.rhs_value = getDigits(record.rhs_digits);
+        }
+        return true;
+    }
+};
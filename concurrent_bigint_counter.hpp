@@ -0,0 +1,261 @@
+/**
+ * @file concurrent_bigint_counter.hpp
+ * @brief This file contains a sharded counter for accumulating bigint totals from many threads.
+ *
+ * Every thread is mapped to one shard. A shard keeps its running total in two machine words
+ * (low word and carries out of it), so an increment is a handful of plain stores on a cache line
+ * owned by that thread. Totals that outgrow the two words, and bigint deltas, are spilled into a
+ * per-shard bigint. Reading the counter combines all shards without blocking the writers.
+ *
+ * @version 1.0
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bigint.hpp"
+
+/**
+ * @class concurrent_bigint_counter
+ * @brief A counter that can be incremented from many threads and grows past 128 bits.
+ *
+ * Increments are wait-free as long as every thread owns its own shard (no more running threads
+ * than shards); when threads share a shard they briefly spin on each other. Reads return a
+ * linearizable snapshot: the value the counter held at one instant during the call.
+ */
+class concurrent_bigint_counter
+{
+private:
+    /**
+     * @brief One thread-local accumulator, padded to its own cache line.
+     *
+     * The sequence number is even while the shard is stable and odd while a writer updates it,
+     * so readers can detect torn reads and retry (a seqlock).
+     */
+    struct alignas(64) shard
+    {
+        std::atomic<uint64_t> sequence{0}; // Seqlock sequence number
+        std::atomic<uint64_t> low{0};      // Low machine word of the shard total
+        std::atomic<uint64_t> high{0};     // Carries out of the low word
+        std::atomic<bool> has_spill{false};
+        std::mutex spill_mutex; // Guards spill
+        bigint spill;           // Everything that did not fit in the two words
+    };
+
+    std::unique_ptr<shard[]> shards;
+    size_t num_shards;
+
+    /**
+     * @brief Returns a small integer identifying the calling thread.
+     */
+    static size_t threadIndex()
+    {
+        static std::atomic<size_t> next{0};
+        thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+
+    /**
+     * @brief Enters the writer side of a shard's seqlock.
+     *
+     * @return The (even) sequence number observed before entering.
+     */
+    static uint64_t beginWrite(shard &s)
+    {
+        uint64_t seq = s.sequence.load(std::memory_order_relaxed);
+        while ((seq & 1) != 0 ||
+               !s.sequence.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed))
+        {
+            // Another thread mapped to this shard is writing
+            seq = s.sequence.load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+        return seq;
+    }
+
+    /**
+     * @brief Leaves the writer side of a shard's seqlock.
+     */
+    static void endWrite(shard &s, uint64_t seq)
+    {
+        s.sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief Adds a bigint to the spill of a shard. Must be called between beginWrite and endWrite.
+     */
+    static void addToSpill(shard &s, const bigint &delta)
+    {
+        std::lock_guard<std::mutex> lock(s.spill_mutex);
+        s.spill += delta;
+        s.has_spill.store(true, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Value of a shard as observed by one consistent read.
+     */
+    struct shardValue
+    {
+        uint64_t sequence;
+        uint64_t low;
+        uint64_t high;
+        bigint spill;
+    };
+
+    /**
+     * @brief Reads a shard without tearing, retrying if a writer was active.
+     */
+    static shardValue readShard(shard &s)
+    {
+        shardValue value;
+        while (true)
+        {
+            uint64_t before = s.sequence.load(std::memory_order_acquire);
+            if ((before & 1) != 0)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            value.low = s.low.load(std::memory_order_relaxed);
+            value.high = s.high.load(std::memory_order_relaxed);
+            if (s.has_spill.load(std::memory_order_relaxed))
+            {
+                std::lock_guard<std::mutex> lock(s.spill_mutex);
+                value.spill = s.spill;
+            }
+            else
+            {
+                value.spill = bigint();
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.sequence.load(std::memory_order_relaxed) == before)
+            {
+                value.sequence = before;
+                return value;
+            }
+        }
+    }
+
+public:
+    /**
+     * @brief Constructs a counter with the given number of shards, initialized to 0.
+     *
+     * @param count Number of shards. 0 picks one shard per hardware thread.
+     */
+    explicit concurrent_bigint_counter(size_t count = 0)
+        : num_shards(count != 0 ? count : std::max<size_t>(1, std::thread::hardware_concurrency()))
+    {
+        shards.reset(new shard[num_shards]);
+    }
+
+    concurrent_bigint_counter(const concurrent_bigint_counter &) = delete;
+    concurrent_bigint_counter &operator=(const concurrent_bigint_counter &) = delete;
+
+    /**
+     * @brief Returns the number of shards.
+     */
+    size_t shard_count() const
+    {
+        return num_shards;
+    }
+
+    /**
+     * @brief Adds a machine word to the counter.
+     *
+     * @param delta The amount to add.
+     */
+    void add(uint64_t delta)
+    {
+        shard &s = shards[threadIndex() % num_shards];
+        uint64_t seq = beginWrite(s);
+        uint64_t low = s.low.load(std::memory_order_relaxed);
+        uint64_t sum = low + delta;
+        s.low.store(sum, std::memory_order_relaxed);
+        // carry out of the low word
+        if (sum < low)
+        {
+            uint64_t high = s.high.load(std::memory_order_relaxed) + 1;
+            s.high.store(high, std::memory_order_relaxed);
+            // both words wrapped, move 2^128 into the spill
+            if (high == 0)
+            {
+                addToSpill(s, bigint("340282366920938463463374607431768211456"));
+            }
+        }
+        endWrite(s, seq);
+    }
+
+    /**
+     * @brief Adds an arbitrary bigint to the counter.
+     *
+     * This takes the shard's spill lock, so prefer add(uint64_t) on hot paths.
+     *
+     * @param delta The amount to add, may be negative.
+     */
+    void add(const bigint &delta)
+    {
+        shard &s = shards[threadIndex() % num_shards];
+        uint64_t seq = beginWrite(s);
+        addToSpill(s, delta);
+        endWrite(s, seq);
+    }
+
+    /**
+     * @brief Increments the counter by 1.
+     */
+    void increment()
+    {
+        add(static_cast<uint64_t>(1));
+    }
+
+    /**
+     * @brief Returns a snapshot of the counter.
+     *
+     * All shards are collected and then their sequence numbers are checked again. If no shard
+     * changed in between, the collected values all held at the same instant, so their sum is a
+     * value the counter really had. Otherwise the collection is repeated.
+     *
+     * @return The total of all increments.
+     */
+    bigint value() const
+    {
+        const bigint two64("18446744073709551616");
+        std::vector<shardValue> values(num_shards);
+        while (true)
+        {
+            for (size_t i = 0; i < num_shards; i++)
+            {
+                values[i] = readShard(shards[i]);
+            }
+            bool stable = true;
+            for (size_t i = 0; i < num_shards && stable; i++)
+            {
+                stable = shards[i].sequence.load(std::memory_order_acquire) == values[i].sequence;
+            }
+            if (stable)
+            {
+                break;
+            }
+        }
+
+        bigint total;
+        for (const shardValue &v : values)
+        {
+            if (v.high != 0)
+            {
+                total += bigint(std::to_string(v.high)) * two64;
+            }
+            total += bigint(std::to_string(v.low));
+            total += v.spill;
+        }
+        return total;
+    }
+};
@@ -0,0 +1,409 @@
+/**
+ * @file factor.hpp
+ * @brief This file contains integer factorization: trial division, Pollard rho and the elliptic
+ * curve method (ECM).
+ *
+ * factor() strips small primes by trial division, then splits the remaining composites with
+ * Pollard rho, which quickly finds factors of up to about 12 digits, and falls back to ECM for
+ * larger factors. ECM curves are independent and run in parallel. Every stage has an effort limit,
+ * and composites that survive all stages are returned as unfactored instead of looping forever.
+ *
+ * Trial division and the ECM prime lists come from prime_sieve. Rho and ECM run in Montgomery form modulo the composite; trial division always removes 2 and 5
+ * first, so the composite is coprime to 10.
+ *
+ * @version 1.0
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "bigint.hpp"
+#include "modular.hpp"
+#include "prime_sieve.hpp"
+
+/**
+ * @brief Effort limits of factor().
+ */
+struct factor_options
+{
+    uint64_t trial_limit = 10000;   // Trial division by all primes up to this bound
+    uint64_t rho_iterations = 20000; // Pollard rho steps per composite, 0 skips rho
+    unsigned ecm_curves = 200;      // ECM curves per composite, 0 skips ECM
+    uint64_t ecm_b1 = 2000;         // ECM stage 1 bound
+    uint64_t ecm_b2 = 0;            // ECM stage 2 bound, 0 means 100 * b1
+    unsigned threads = 0;           // Threads running ECM curves, 0 means bigint::max_threads()
+};
+
+/**
+ * @brief The result of factor().
+ */
+struct factorization
+{
+    std::vector<bigint> factors;    // Prime factors with multiplicity, in increasing order
+    std::vector<bigint> unfactored; // Composites that no stage could split within its limits
+
+    /**
+     * @brief Returns whether the factorization is complete.
+     */
+    bool complete() const
+    {
+        return unfactored.empty();
+    }
+};
+
+/**
+ * @brief Looks for a factor with Pollard rho, using Brent's cycle detection.
+ *
+ * The differences |x - y| are multiplied together and one gcd is taken per batch of 128 steps;
+ * if a batch overshoots to gcd = n, the batch is replayed one step at a time.
+ *
+ * @param n The composite to split, odd and coprime to 10.
+ * @param iterations Maximum number of steps over all attempts.
+ * @return A nontrivial factor of n, or 1 if none was found.
+ */
+inline bigint pollard_rho(const bigint &n, uint64_t iterations)
+{
+    const uint64_t batch = 128;
+    montgomery reducer(n);
+    uint64_t steps = 0;
+    for (int64_t c = 1; steps < iterations; c++)
+    {
+        bigint increment = reducer.to_form(bigint(c));
+        auto next = [&](const bigint &x)
+        {
+            return reducer.add(reducer.multiply(x, x), increment);
+        };
+        bigint y = reducer.to_form(bigint(2));
+        bigint x;
+        bigint saved;
+        bigint product = reducer.one();
+        bigint g(1);
+        for (uint64_t r = 1; g == bigint(1) && steps < iterations; r *= 2)
+        {
+            x = y;
+            for (uint64_t i = 0; i < r; i++)
+                y = next(y);
+            steps += r;
+            for (uint64_t k = 0; k < r && g == bigint(1) && steps < iterations; k += batch)
+            {
+                saved = y;
+                for (uint64_t i = 0; i < std::min(batch, r - k); i++)
+                {
+                    y = next(y);
+                    product = reducer.multiply(product, reducer.subtract(x, y));
+                }
+                steps += std::min(batch, r - k);
+                // gcd(q * R, n) = gcd(q, n), no conversion out of Montgomery form needed
+                g = gcd(product, n);
+            }
+        }
+        if (g == n)
+        {
+            // the batch collected every prime factor at once, replay it step by step
+            do
+            {
+                saved = next(saved);
+                g = gcd(reducer.subtract(x, saved), n);
+            } while (g == bigint(1));
+        }
+        if (g != bigint(1) && g != n)
+            return g;
+    }
+    return bigint(1);
+}
+
+/**
+ * @class ecm_curve
+ * @brief Arithmetic on one Montgomery curve By^2 = x^3 + Ax^2 + x, on x-coordinates only.
+ *
+ * Points are projective (X : Z). The curve constant is kept as the fraction (A + 2) / 4 =
+ * a24 / c24, so no modular inverse is ever needed.
+ */
+class ecm_curve
+{
+public:
+    struct point
+    {
+        bigint x;
+        bigint z;
+    };
+
+private:
+    const montgomery &reducer;
+    bigint a24;
+    bigint c24;
+
+public:
+    /**
+     * @brief Builds the curve and starting point of Suyama's parametrization for sigma.
+     *
+     * With u = sigma^2 - 5 and v = 4 sigma the group order is divisible by 12, and the start is
+     * (u^3 : v^3), with (A + 2) / 4 = (v - u)^3 (3u + v) / (16 u^3 v).
+     */
+    ecm_curve(const montgomery &montgomeryReducer, uint64_t sigma, point &start) : reducer(montgomeryReducer)
+    {
+        const montgomery &m = reducer;
+        bigint s = m.to_form(bigint(std::to_string(sigma)));
+        bigint u = m.subtract(m.multiply(s, s), m.to_form(bigint(5)));
+        bigint v = m.add(m.add(s, s), m.add(s, s));
+        bigint u3 = m.multiply(m.multiply(u, u), u);
+        bigint vMinusU = m.subtract(v, u);
+        start.x = u3;
+        start.z = m.multiply(m.multiply(v, v), v);
+        a24 = m.multiply(m.multiply(m.multiply(vMinusU, vMinusU), vMinusU), m.add(m.add(m.add(u, u), u), v));
+        c24 = m.multiply(m.to_form(bigint(16)), m.multiply(u3, v));
+    }
+
+    /**
+     * @brief Returns 2P.
+     */
+    point twice(const point &p) const
+    {
+        const montgomery &m = reducer;
+        bigint sum = m.add(p.x, p.z);
+        bigint difference = m.subtract(p.x, p.z);
+        bigint t0 = m.multiply(difference, difference);
+        bigint t1 = m.multiply(sum, sum);
+        bigint z = m.multiply(c24, t0);
+        point result;
+        result.x = m.multiply(z, t1);
+        t1 = m.subtract(t1, t0); // 4XZ
+        result.z = m.multiply(m.add(z, m.multiply(a24, t1)), t1);
+        return result;
+    }
+
+    /**
+     * @brief Returns P + Q given P - Q.
+     */
+    point sum(const point &p, const point &q, const point &difference) const
+    {
+        const montgomery &m = reducer;
+        bigint u = m.multiply(m.subtract(p.x, p.z), m.add(q.x, q.z));
+        bigint v = m.multiply(m.add(p.x, p.z), m.subtract(q.x, q.z));
+        bigint plus = m.add(u, v);
+        bigint minus = m.subtract(u, v);
+        point result;
+        result.x = m.multiply(difference.z, m.multiply(plus, plus));
+        result.z = m.multiply(difference.x, m.multiply(minus, minus));
+        return result;
+    }
+
+    /**
+     * @brief Returns kP with the Montgomery ladder.
+     *
+     * @param p The point.
+     * @param k The scalar, at least 1.
+     */
+    point multiple(const point &p, uint64_t k) const
+    {
+        if (k == 1)
+            return p;
+        point low = p;
+        point high = twice(p);
+        int bit = 63;
+        while ((k >> bit) == 0)
+            bit--;
+        for (bit--; bit >= 0; bit--)
+        {
+            if ((k >> bit) & 1)
+            {
+                low = sum(high, low, p);
+                high = twice(high);
+            }
+            else
+            {
+                high = sum(high, low, p);
+                low = twice(low);
+            }
+        }
+        return low;
+    }
+};
+
+/**
+ * @brief Runs one ECM curve, stage 1 then stage 2.
+ *
+ * Stage 1 multiplies the start point by every prime power up to b1. Stage 2 looks for one more
+ * prime q in (b1, b2] with a baby-step giant-step walk: q = mD +- j is caught by the cross
+ * product X_mD Z_j - X_j Z_mD, and all cross products are multiplied before a single gcd.
+ *
+ * @param reducer Montgomery arithmetic modulo the composite n.
+ * @param sigma The curve parameter, at least 6.
+ * @param primes All primes up to b2.
+ * @param b1 Stage 1 bound.
+ * @param b2 Stage 2 bound.
+ * @param stop Set by another thread once a factor is found, aborts the curve.
+ * @return gcd of the result with n, 1 if the curve found nothing.
+ */
+inline bigint ecm_run_curve(const montgomery &reducer, uint64_t sigma, const std::vector<uint64_t> &primes,
+                            uint64_t b1, uint64_t b2, const std::atomic<bool> &stop)
+{
+    const bigint &n = reducer.modulus();
+    ecm_curve::point q;
+    ecm_curve curve(reducer, sigma, q);
+
+    // stage 1
+    for (size_t i = 0; i < primes.size() && primes[i] <= b1; i++)
+    {
+        uint64_t power = primes[i];
+        while (power <= b1 / primes[i])
+            power *= primes[i];
+        q = curve.multiple(q, power);
+        if (i % 64 == 0 && stop.load(std::memory_order_relaxed))
+            return bigint(1);
+    }
+    bigint g = gcd(q.z, n);
+    if (g != bigint(1))
+        return g;
+
+    // stage 2: baby steps jQ for j < D/2 coprime to D, giant steps mDQ
+    const uint64_t d = 210;
+    std::vector<ecm_curve::point> baby(d / 2);
+    ecm_curve::point twiceQ = curve.twice(q);
+    baby[1] = q;
+    baby[3] = curve.sum(twiceQ, q, q);
+    for (uint64_t j = 5; j < d / 2; j += 2)
+        baby[j] = curve.sum(baby[j - 2], twiceQ, baby[j - 4]);
+
+    std::vector<char> isPrime(b2 + d + 1, 0);
+    for (uint64_t p : primes)
+    {
+        if (p <= b2)
+            isPrime[p] = 1;
+    }
+    uint64_t m = std::max<uint64_t>(1, b1 / d);
+    ecm_curve::point giant = curve.multiple(q, d);
+    ecm_curve::point previous = curve.multiple(q, (m - 1) * d == 0 ? d : (m - 1) * d);
+    ecm_curve::point current = curve.multiple(q, m * d);
+    bool previousIsGiant = m == 1; // (m - 1) D Q is the point at infinity when m = 1
+    bigint product = reducer.one();
+    for (; m * d <= b2 + d; m++)
+    {
+        for (uint64_t j = 1; j < d / 2; j += 2)
+        {
+            if (baby[j].z == bigint())
+                continue;
+            bool hit = (m * d + j <= b2 && m * d + j > b1 && isPrime[m * d + j]) ||
+                       (m * d - j <= b2 && m * d - j > b1 && isPrime[m * d - j]);
+            if (hit)
+            {
+                bigint cross = reducer.subtract(reducer.multiply(current.x, baby[j].z), reducer.multiply(baby[j].x, current.z));
+                product = reducer.multiply(product, cross);
+            }
+        }
+        if (stop.load(std::memory_order_relaxed))
+            return bigint(1);
+        ecm_curve::point next = previousIsGiant ? curve.twice(current) : curve.sum(current, giant, previous);
+        previousIsGiant = false;
+        previous = current;
+        current = next;
+    }
+    return gcd(product, n);
+}
+
+/**
+ * @brief Looks for a factor with the elliptic curve method, running curves on several threads.
+ *
+ * @param n The composite to split, odd and coprime to 10.
+ * @param options Number of curves, stage bounds and thread count.
+ * @return A nontrivial factor of n, or 1 if no curve found one.
+ */
+inline bigint ecm(const bigint &n, const factor_options &options)
+{
+    if (options.ecm_curves == 0)
+        return bigint(1);
+    uint64_t b1 = std::max<uint64_t>(options.ecm_b1, 11);
+    uint64_t b2 = std::max(options.ecm_b2 != 0 ? options.ecm_b2 : 100 * b1, b1);
+    montgomery reducer(n);
+    std::vector<uint64_t> primes = prime_sieve(b2).primes(options.threads);
+
+    std::atomic<unsigned> nextCurve{0};
+    std::atomic<bool> found{false};
+    std::mutex resultMutex;
+    bigint result(1);
+    auto worker = [&]()
+    {
+        unsigned curve;
+        while (!found.load(std::memory_order_relaxed) && (curve = nextCurve.fetch_add(1)) < options.ecm_curves)
+        {
+            bigint g = ecm_run_curve(reducer, 6 + curve, primes, b1, b2, found);
+            if (g != bigint(1) && g != n)
+            {
+                std::lock_guard<std::mutex> lock(resultMutex);
+                if (!found.exchange(true))
+                    result = g;
+            }
+        }
+    };
+    unsigned threadCount = std::min(options.threads != 0 ? options.threads : bigint::max_threads(), options.ecm_curves);
+    std::vector<std::thread> threads;
+    for (unsigned t = 1; t < threadCount; t++)
+        threads.emplace_back(worker);
+    worker();
+    for (std::thread &thread : threads)
+        thread.join();
+    return result;
+}
+
+/**
+ * @brief Factors an integer into primes.
+ *
+ * @param n The number to factor; the sign is ignored.
+ * @param options Effort limits of the stages.
+ * @return The prime factors, and any composites left over when the limits were reached.
+ * @throws std::invalid_argument If n is 0.
+ */
+inline factorization factor(const bigint &n, const factor_options &options = factor_options())
+{
+    if (n == bigint())
+        throw std::invalid_argument("Cannot factor 0");
+    factorization result;
+    bigint rest = n.negative() ? -n : n;
+
+    // 2 and 5 always go, Montgomery arithmetic below needs a modulus coprime to 10
+    for (uint64_t p : prime_sieve(std::max<uint64_t>(options.trial_limit, 5)))
+    {
+        if (rest.digit_count() <= 19 && modular_kernels::word(rest) < p * p)
+            break;
+        while (modular_kernels::remainder(rest, p) == 0)
+        {
+            bigint prime(static_cast<int64_t>(p));
+            result.factors.push_back(prime);
+            rest = rest / prime;
+        }
+    }
+
+    std::vector<bigint> pending;
+    if (rest != bigint(1))
+        pending.push_back(rest);
+    while (!pending.empty())
+    {
+        bigint composite = pending.back();
+        pending.pop_back();
+        if (is_probable_prime(composite))
+        {
+            result.factors.push_back(composite);
+            continue;
+        }
+        bigint divisor = pollard_rho(composite, options.rho_iterations);
+        if (divisor == bigint(1))
+            divisor = ecm(composite, options);
+        if (divisor == bigint(1))
+        {
+            result.unfactored.push_back(composite);
+            continue;
+        }
+        pending.push_back(divisor);
+        pending.push_back(composite / divisor);
+    }
+    std::sort(result.factors.begin(), result.factors.end());
+    std::sort(result.unfactored.begin(), result.unfactored.end());
+    return result;
+}
@@ -0,0 +1,707 @@
+/**
+ * @file modular.hpp
+ * @brief This file contains modular exponentiation on bigints: a Montgomery engine, single
+ * exponentiation and simultaneous multi-exponentiation (Straus and Pippenger).
+ *
+ * Montgomery arithmetic is done in base 10, matching the digit storage of bigint: for a modulus m
+ * of k digits, R = 10^k, and reduction clears one low digit per step using m' = -m^-1 mod 10. It
+ * therefore needs a modulus coprime to 10; other moduli fall back to reduction by division.
+ *
+ * All exponentiation routines are templates over a reducer, which is any type providing
+ * modulus(), one(), to_form(x), from_form(x), multiply(a, b), add(a, b) and subtract(a, b) on
+ * values in its internal form.
+ *
+ * Also contains gcd, modular inverse and a Miller-Rabin primality test.
+ *
+ * @version 1.0
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bigint.hpp"
+
+/**
+ * @brief Digit-level helpers shared by the reducers. Friend of bigint.
+ */
+struct modular_kernels
+{
+    /**
+     * @brief Returns the binary digits of a non-negative bigint, least significant first.
+     */
+    static std::vector<uint8_t> bits(const bigint &value)
+    {
+        return value.toRadix(2);
+    }
+
+    /**
+     * @brief Returns the magnitude of a bigint of at most 19 digits as a machine word.
+     */
+    static uint64_t word(const bigint &value)
+    {
+        uint64_t result = 0;
+        for (size_t i = value.digits.size(); i > 0; i--)
+        {
+            result = result * 10 + value.digits[i - 1];
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns |value| mod divisor without building a bigint divisor.
+     *
+     * @param value The dividend.
+     * @param divisor The divisor, nonzero and below 2^32.
+     */
+    static uint64_t remainder(const bigint &value, uint64_t divisor)
+    {
+        uint64_t result = 0;
+        for (size_t i = value.digits.size(); i > 0; i--)
+        {
+            result = (result * 10 + value.digits[i - 1]) % divisor;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Returns the lowest decimal digit of a bigint's magnitude.
+     */
+    static uint8_t lowDigit(const bigint &value)
+    {
+        return value.digits[0];
+    }
+
+    /**
+     * @brief Montgomery reduction in base 10: returns t / 10^width mod m.
+     *
+     * @param t The value to reduce, 0 <= t < m * 10^width.
+     * @param m The modulus, of exactly width digits and coprime to 10.
+     * @param width The digit count of m.
+     * @param inverse -m^-1 mod 10.
+     * @return The reduced value, in [0, m).
+     */
+    static bigint redc(bigint t, const bigint &m, size_t width, uint8_t inverse)
+    {
+        const std::vector<uint8_t> &md = m.digits;
+        std::vector<uint8_t> &td = t.digits;
+        td.resize(std::max(td.size(), 2 * width) + 1, 0);
+        for (size_t i = 0; i < width; i++)
+        {
+            // adding u * m * 10^i clears digit i
+            unsigned u = (td[i] * inverse) % 10;
+            if (u == 0)
+                continue;
+            unsigned carry = 0;
+            size_t j = 0;
+            for (; j < md.size(); j++)
+            {
+                unsigned v = td[i + j] + u * md[j] + carry;
+                td[i + j] = static_cast<uint8_t>(v % 10);
+                carry = v / 10;
+            }
+            for (size_t index = i + j; carry != 0; index++)
+            {
+                unsigned v = td[index] + carry;
+                td[index] = static_cast<uint8_t>(v % 10);
+                carry = v / 10;
+            }
+        }
+        td.erase(td.begin(), td.begin() + static_cast<std::ptrdiff_t>(width));
+        t.removeLeadingZeros();
+        if (t.compareMagnitude(m) >= 0)
+            t = t - m;
+        return t;
+    }
+};
+
+/**
+ * @brief Returns x mod m in [0, m).
+ *
+ * @param x The value to reduce.
+ * @param m The modulus, positive.
+ * @return The least non-negative residue.
+ */
+inline bigint reduce_mod(const bigint &x, const bigint &m)
+{
+    bigint r = x % m;
+    if (r.negative())
+        r += m;
+    return r;
+}
+
+/**
+ * @class montgomery
+ * @brief Montgomery multiplication modulo a fixed modulus coprime to 10.
+ *
+ * Values in Montgomery form are x * R mod m with R = 10^k, k the digit count of m. A product of
+ * two such values costs one full multiplication and one reduction, with no division.
+ */
+class montgomery
+{
+private:
+    bigint mod;
+    size_t width;      // Digit count of the modulus
+    uint8_t inverse;   // -m^-1 mod 10
+    bigint r_squared;  // R^2 mod m, converts into Montgomery form
+    bigint unit;       // R mod m, the form of 1
+
+public:
+    /**
+     * @brief Prepares the reduction constants for a modulus.
+     *
+     * @param modulus The modulus, positive and coprime to 10.
+     * @throws std::invalid_argument If the modulus is not positive or shares a factor with 10.
+     */
+    explicit montgomery(const bigint &modulus) : mod(modulus), width(modulus.digit_count()), inverse(0)
+    {
+        if (modulus <= bigint())
+            throw std::invalid_argument("Modulus must be positive");
+        static const uint8_t inverses[10] = {0, 1, 0, 7, 0, 0, 0, 3, 0, 9};
+        uint8_t low = modular_kernels::lowDigit(modulus);
+        if (inverses[low] == 0)
+            throw std::invalid_argument("Montgomery modulus must be coprime to 10");
+        inverse = static_cast<uint8_t>((10 - inverses[low]) % 10);
+        r_squared = bigint("1" + std::string(2 * width, '0')) % mod;
+        unit = bigint("1" + std::string(width, '0')) % mod;
+    }
+
+    /**
+     * @brief Returns whether a modulus can be used with Montgomery reduction.
+     */
+    static bool supports(const bigint &modulus)
+    {
+        uint8_t low = modular_kernels::lowDigit(modulus);
+        return modulus > bigint() && low % 2 == 1 && low != 5;
+    }
+
+    const bigint &modulus() const
+    {
+        return mod;
+    }
+
+    /**
+     * @brief Returns 1 in Montgomery form.
+     */
+    const bigint &one() const
+    {
+        return unit;
+    }
+
+    /**
+     * @brief Converts a value into Montgomery form.
+     *
+     * @param x Any bigint, reduced modulo m first.
+     * @return x * R mod m.
+     */
+    bigint to_form(const bigint &x) const
+    {
+        return modular_kernels::redc(reduce_mod(x, mod) * r_squared, mod, width, inverse);
+    }
+
+    /**
+     * @brief Converts a value out of Montgomery form.
+     *
+     * @param x A value in Montgomery form.
+     * @return x * R^-1 mod m.
+     */
+    bigint from_form(const bigint &x) const
+    {
+        return modular_kernels::redc(x, mod, width, inverse);
+    }
+
+    /**
+     * @brief Multiplies two values in Montgomery form.
+     *
+     * @return a * b * R^-1 mod m, in Montgomery form.
+     */
+    bigint multiply(const bigint &a, const bigint &b) const
+    {
+        return modular_kernels::redc(a * b, mod, width, inverse);
+    }
+
+    /**
+     * @brief Adds two reduced values. Works in and out of Montgomery form alike.
+     */
+    bigint add(const bigint &a, const bigint &b) const
+    {
+        bigint sum = a + b;
+        if (sum >= mod)
+            sum -= mod;
+        return sum;
+    }
+
+    /**
+     * @brief Subtracts two reduced values. Works in and out of Montgomery form alike.
+     */
+    bigint subtract(const bigint &a, const bigint &b) const
+    {
+        bigint difference = a - b;
+        if (difference.negative())
+            difference += mod;
+        return difference;
+    }
+};
+
+/**
+ * @class division_reducer
+ * @brief Plain modular multiplication that reduces by long division. Works for any positive modulus.
+ */
+class division_reducer
+{
+private:
+    bigint mod;
+    bigint unit;
+
+public:
+    /**
+     * @brief Creates a reducer for a modulus.
+     *
+     * @param modulus The modulus, positive.
+     * @throws std::invalid_argument If the modulus is not positive.
+     */
+    explicit division_reducer(const bigint &modulus) : mod(modulus)
+    {
+        if (modulus <= bigint())
+            throw std::invalid_argument("Modulus must be positive");
+        unit = bigint(1) % mod;
+    }
+
+    const bigint &modulus() const
+    {
+        return mod;
+    }
+
+    const bigint &one() const
+    {
+        return unit;
+    }
+
+    bigint to_form(const bigint &x) const
+    {
+        return reduce_mod(x, mod);
+    }
+
+    bigint from_form(const bigint &x) const
+    {
+        return x;
+    }
+
+    bigint multiply(const bigint &a, const bigint &b) const
+    {
+        return (a * b) % mod;
+    }
+
+    bigint add(const bigint &a, const bigint &b) const
+    {
+        bigint sum = a + b;
+        if (sum >= mod)
+            sum -= mod;
+        return sum;
+    }
+
+    bigint subtract(const bigint &a, const bigint &b) const
+    {
+        bigint difference = a - b;
+        if (difference.negative())
+            difference += mod;
+        return difference;
+    }
+};
+
+/**
+ * @brief Reads a window of bits, least significant bit at position start.
+ *
+ * @param bits Binary digits, least significant first.
+ * @param start Position of the lowest bit of the window.
+ * @param width Width of the window.
+ * @return The window's value, bits past the end read as 0.
+ */
+inline size_t exponent_window(const std::vector<uint8_t> &bits, size_t start, size_t width)
+{
+    size_t value = 0;
+    for (size_t b = std::min(bits.size(), start + width); b > start; b--)
+    {
+        value = (value << 1) | bits[b - 1];
+    }
+    return value;
+}
+
+/**
+ * @brief Returns the binary digits of an exponent.
+ *
+ * @throws std::invalid_argument If the exponent is negative.
+ */
+inline std::vector<uint8_t> exponent_bits(const bigint &exponent)
+{
+    if (exponent.negative())
+        throw std::invalid_argument("Negative exponent");
+    return modular_kernels::bits(exponent);
+}
+
+/**
+ * @brief Computes base^exponent mod m with a fixed 4-bit window.
+ *
+ * @param reducer The modular arithmetic to use.
+ * @param base The base, any bigint.
+ * @param exponent The exponent, non-negative.
+ * @return The power, in [0, m).
+ */
+template <typename Reducer>
+bigint powmod(const Reducer &reducer, const bigint &base, const bigint &exponent)
+{
+    std::vector<uint8_t> bits = exponent_bits(exponent);
+    const size_t window = 4;
+    std::vector<bigint> table(size_t(1) << window);
+    table[0] = reducer.one();
+    table[1] = reducer.to_form(base);
+    for (size_t i = 2; i < table.size(); i++)
+    {
+        table[i] = reducer.multiply(table[i - 1], table[1]);
+    }
+    bigint result = reducer.one();
+    size_t windows = (bits.size() + window - 1) / window;
+    for (size_t w = windows; w > 0; w--)
+    {
+        if (w != windows)
+        {
+            for (size_t s = 0; s < window; s++)
+                result = reducer.multiply(result, result);
+        }
+        size_t digit = exponent_window(bits, (w - 1) * window, window);
+        if (digit != 0)
+            result = reducer.multiply(result, table[digit]);
+    }
+    return reducer.from_form(result);
+}
+
+/**
+ * @brief Computes base^exponent mod modulus, with Montgomery reduction when the modulus allows it.
+ *
+ * @param base The base, any bigint.
+ * @param exponent The exponent, non-negative.
+ * @param modulus The modulus, positive.
+ * @return The power, in [0, modulus).
+ * @throws std::invalid_argument If the exponent is negative or the modulus is not positive.
+ */
+inline bigint powmod(const bigint &base, const bigint &exponent, const bigint &modulus)
+{
+    if (montgomery::supports(modulus))
+        return powmod(montgomery(modulus), base, exponent);
+    return powmod(division_reducer(modulus), base, exponent);
+}
+
+/**
+ * @brief Below this many bases multi_powmod uses Straus' method, from it on Pippenger's.
+ */
+constexpr size_t pippenger_threshold = 32;
+
+/**
+ * @brief Computes the product of bases[i]^exps[i] mod m in one pass over the exponent bits.
+ *
+ * All powers share the same squarings. With few bases, Straus' method interleaves fixed windows
+ * of every exponent against per-base tables of small powers. With many bases, Pippenger's method
+ * instead sorts the bases of each window into buckets by window value and combines the buckets
+ * with two running products, so the cost per window is one multiplication per base plus two per
+ * bucket. The windows of Pippenger's method are independent and are spread over threads.
+ *
+ * @param reducer The modular arithmetic to use.
+ * @param bases The bases, any bigints.
+ * @param exps The exponents, non-negative, one per base.
+ * @param threads Maximum number of threads for Pippenger's method.
+ * @return The product of the powers, in [0, m).
+ * @throws std::invalid_argument If the sizes differ or an exponent is negative.
+ */
+template <typename Reducer>
+bigint multi_powmod(const Reducer &reducer, const std::vector<bigint> &bases, const std::vector<bigint> &exps,
+                    unsigned threads = bigint::max_threads())
+{
+    if (bases.size() != exps.size())
+        throw std::invalid_argument("Mismatched bases and exponents");
+    const size_t count = bases.size();
+    std::vector<std::vector<uint8_t>> bits(count);
+    std::vector<bigint> forms(count);
+    size_t length = 0;
+    for (size_t i = 0; i < count; i++)
+    {
+        bits[i] = exponent_bits(exps[i]);
+        forms[i] = reducer.to_form(bases[i]);
+        length = std::max(length, bits[i].size());
+    }
+    if (count == 0)
+        return reducer.from_form(reducer.one());
+
+    if (count < pippenger_threshold)
+    {
+        // Straus: tables of base^1 .. base^(2^w - 1), one shared squaring chain
+        size_t window = length > 512 ? 4 : length > 64 ? 3 : 2;
+        std::vector<std::vector<bigint>> tables(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            tables[i].resize(size_t(1) << window);
+            tables[i][1] = forms[i];
+            for (size_t d = 2; d < tables[i].size(); d++)
+            {
+                tables[i][d] = reducer.multiply(tables[i][d - 1], forms[i]);
+            }
+        }
+        bigint result = reducer.one();
+        bool started = false;
+        for (size_t w = (length + window - 1) / window; w > 0; w--)
+        {
+            if (started)
+            {
+                for (size_t s = 0; s < window; s++)
+                    result = reducer.multiply(result, result);
+            }
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t digit = exponent_window(bits[i], (w - 1) * window, window);
+                if (digit == 0)
+                    continue;
+                result = started ? reducer.multiply(result, tables[i][digit]) : tables[i][digit];
+                started = true;
+            }
+        }
+        return reducer.from_form(result);
+    }
+
+    // Pippenger: pick the window minimizing windows * (bases + 2 * buckets)
+    size_t window = 1;
+    for (size_t c = 2; c <= 16; c++)
+    {
+        size_t cost = (length + c - 1) / c * (count + (size_t(2) << c));
+        size_t best = (length + window - 1) / window * (count + (size_t(2) << window));
+        if (cost < best)
+            window = c;
+    }
+    size_t windows = (length + window - 1) / window;
+    std::vector<bigint> sums(windows);
+    std::vector<char> nonTrivial(windows, 0);
+
+    // sums[w] = product over buckets d of (product of bases with window value d)^d
+    auto windowSum = [&](size_t w)
+    {
+        std::vector<bigint> buckets(size_t(1) << window);
+        std::vector<char> filled(buckets.size(), 0);
+        for (size_t i = 0; i < count; i++)
+        {
+            size_t digit = exponent_window(bits[i], w * window, window);
+            if (digit == 0)
+                continue;
+            buckets[digit] = filled[digit] ? reducer.multiply(buckets[digit], forms[i]) : forms[i];
+            filled[digit] = 1;
+        }
+        bigint running;
+        bigint total;
+        bool hasRunning = false;
+        bool hasTotal = false;
+        for (size_t d = buckets.size() - 1; d > 0; d--)
+        {
+            if (filled[d])
+            {
+                running = hasRunning ? reducer.multiply(running, buckets[d]) : buckets[d];
+                hasRunning = true;
+            }
+            if (hasRunning)
+            {
+                total = hasTotal ? reducer.multiply(total, running) : running;
+                hasTotal = true;
+            }
+        }
+        sums[w] = total;
+        nonTrivial[w] = hasTotal ? 1 : 0;
+    };
+
+    unsigned threadCount = static_cast<unsigned>(std::min<size_t>(std::max(1u, threads), windows));
+    std::vector<std::thread> workers;
+    for (unsigned t = 1; t < threadCount; t++)
+    {
+        workers.emplace_back([&, t]()
+                             {
+            for (size_t w = t; w < windows; w += threadCount)
+                windowSum(w); });
+    }
+    for (size_t w = 0; w < windows; w += threadCount)
+    {
+        windowSum(w);
+    }
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+
+    // combine from the top window down, Horner style
+    bigint result = reducer.one();
+    bool started = false;
+    for (size_t w = windows; w > 0; w--)
+    {
+        if (started)
+        {
+            for (size_t s = 0; s < window; s++)
+                result = reducer.multiply(result, result);
+        }
+        if (nonTrivial[w - 1])
+        {
+            result = started ? reducer.multiply(result, sums[w - 1]) : sums[w - 1];
+            started = true;
+        }
+    }
+    return reducer.from_form(result);
+}
+
+/**
+ * @brief Computes the product of bases[i]^exps[i] mod modulus, with Montgomery reduction when
+ * the modulus allows it.
+ *
+ * @param bases The bases, any bigints.
+ * @param exps The exponents, non-negative, one per base.
+ * @param modulus The modulus, positive.
+ * @return The product of the powers, in [0, modulus).
+ * @throws std::invalid_argument If the sizes differ, an exponent is negative or the modulus is not positive.
+ */
+inline bigint multi_powmod(const std::vector<bigint> &bases, const std::vector<bigint> &exps, const bigint &modulus)
+{
+    if (montgomery::supports(modulus))
+        return multi_powmod(montgomery(modulus), bases, exps);
+    return multi_powmod(division_reducer(modulus), bases, exps);
+}
+
+/**
+ * @brief Returns the greatest common divisor of two bigints.
+ *
+ * Euclid's algorithm on bigints until both values fit in a machine word, then on words.
+ *
+ * @return gcd(|a|, |b|), 0 if both are 0.
+ */
+inline bigint gcd(const bigint &a, const bigint &b)
+{
+    bigint x = a.negative() ? -a : a;
+    bigint y = b.negative() ? -b : b;
+    while (y != bigint())
+    {
+        if (x.digit_count() <= 19 && y.digit_count() <= 19)
+        {
+            uint64_t u = modular_kernels::word(x);
+            uint64_t v = modular_kernels::word(y);
+            while (v != 0)
+            {
+                uint64_t t = u % v;
+                u = v;
+                v = t;
+            }
+            return bigint(std::to_string(u));
+        }
+        bigint t = x % y;
+        x = std::move(y);
+        y = std::move(t);
+    }
+    return x;
+}
+
+/**
+ * @brief Returns the inverse of a modulo m, with the extended Euclidean algorithm.
+ *
+ * @param a The value to invert, any bigint.
+ * @param m The modulus, positive.
+ * @return x in [0, m) with a * x = 1 (mod m).
+ * @throws std::invalid_argument If the modulus is not positive or gcd(a, m) != 1.
+ */
+inline bigint mod_inverse(const bigint &a, const bigint &m)
+{
+    if (m <= bigint())
+        throw std::invalid_argument("Modulus must be positive");
+    bigint r0 = m;
+    bigint r1 = reduce_mod(a, m);
+    bigint t0;
+    bigint t1(1);
+    while (r1 != bigint())
+    {
+        bigint q = r0 / r1;
+        bigint r2 = r0 - q * r1;
+        bigint t2 = t0 - q * t1;
+        r0 = std::move(r1);
+        r1 = std::move(r2);
+        t0 = std::move(t1);
+        t1 = std::move(t2);
+    }
+    if (r0 != bigint(1))
+        throw std::invalid_argument("Value is not invertible");
+    return reduce_mod(t0, m);
+}
+
+/**
+ * @brief Tests a number for primality with trial division by small primes and Miller-Rabin.
+ *
+ * The bases are the first 12 primes, which make the test exact below 3.3 * 10^24, followed by
+ * pseudo-random bases for larger numbers. A composite passes with probability at most 4^-rounds.
+ *
+ * @param n The number to test.
+ * @param rounds Number of Miller-Rabin bases, at least 12 are used.
+ * @return Whether n is (probably) prime. Numbers below 2 are not prime.
+ */
+inline bool is_probable_prime(const bigint &n, unsigned rounds = 25)
+{
+    if (n < bigint(2))
+        return false;
+    static const uint64_t smallPrimes[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53, 59, 61, 67, 71, 73, 79, 83, 89, 97};
+    for (uint64_t p : smallPrimes)
+    {
+        if (modular_kernels::remainder(n, p) == 0)
+            return n == bigint(static_cast<int64_t>(p));
+    }
+    if (n < bigint(97 * 97))
+        return true;
+
+    // n - 1 = d * 2^s with d odd
+    montgomery reducer(n);
+    bigint nMinusOne = n - bigint(1);
+    std::vector<uint8_t> bits = exponent_bits(nMinusOne);
+    size_t s = 0;
+    while (bits[s] == 0)
+        s++;
+    bigint d = nMinusOne;
+    for (size_t i = 0; i < s; i++)
+        d = d / bigint(2);
+    bigint minusOne = reducer.to_form(nMinusOne);
+
+    uint64_t state = 0x9E3779B97F4A7C15ULL ^ n.digit_count();
+    for (unsigned round = 0; round < std::max(rounds, 12u); round++)
+    {
+        bigint base;
+        if (round < 12)
+        {
+            base = bigint(static_cast<int64_t>(smallPrimes[round]));
+        }
+        else
+        {
+            std::string text;
+            while (text.size() < n.digit_count() + 2)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                text += std::to_string(state);
+            }
+            // a base in [2, n - 2]
+            base = bigint(text) % (n - bigint(3)) + bigint(2);
+        }
+        bigint x = reducer.to_form(powmod(reducer, base, d));
+        if (x == reducer.one() || x == minusOne)
+            continue;
+        bool witness = true;
+        for (size_t i = 1; i < s && witness; i++)
+        {
+            x = reducer.multiply(x, x);
+            witness = x != minusOne;
+        }
+        if (witness)
+            return false;
+    }
+    return true;
+}
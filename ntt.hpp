@@ -0,0 +1,399 @@
+/**
+ * @file ntt.hpp
+ * @brief This file contains the number-theoretic transform (NTT) engine behind large products.
+ *
+ * Transforms work modulo three primes of the form c * 2^k + 1, all with primitive root 3:
+ *   998244353 = 119 * 2^23 + 1, 469762049 = 7 * 2^26 + 1, 167772161 = 5 * 2^25 + 1.
+ * A convolution is computed modulo one, two or three of them, enough for their product to exceed
+ * the largest coefficient of the result, and the residues are combined with Garner's algorithm
+ * (Chinese remainder theorem).
+ *
+ * Forward transforms are decimation in frequency (natural order in, bit-reversed out) and inverse
+ * transforms decimation in time (bit-reversed in, natural out), so no bit reversal pass is needed
+ * as long as only pointwise products happen in between. Twiddle factors are computed once per
+ * prime and kept for the life of the program. Large transforms split their butterflies over threads.
+ *
+ * @version 1.0
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief The primes an NTT can work modulo.
+ */
+constexpr uint32_t ntt_primes[3] = {998244353, 469762049, 167772161};
+
+/**
+ * @brief log2 of the longest transform each prime supports.
+ */
+constexpr unsigned ntt_max_log[3] = {23, 26, 25};
+
+/**
+ * @brief Which primes a convolution uses and its transform size.
+ */
+struct ntt_plan
+{
+    unsigned log = 0;           // The transform has 2^log points
+    unsigned prime_count = 0;   // Number of primes used
+    unsigned primes[3] = {};    // Indexes into ntt_primes
+};
+
+/**
+ * @class ntt
+ * @brief Static NTT routines: planning, transforms, pointwise products and CRT.
+ */
+class ntt
+{
+private:
+    template <uint32_t P>
+    static uint32_t multiply(uint32_t a, uint32_t b)
+    {
+        return static_cast<uint32_t>(static_cast<uint64_t>(a) * b % P);
+    }
+
+    template <uint32_t P>
+    static uint32_t add(uint32_t a, uint32_t b)
+    {
+        uint32_t sum = a + b; // below 2^31, no overflow
+        return sum >= P ? sum - P : sum;
+    }
+
+    template <uint32_t P>
+    static uint32_t subtract(uint32_t a, uint32_t b)
+    {
+        return a >= b ? a - b : a + P - b;
+    }
+
+    static uint32_t power(uint32_t base, uint64_t exponent, uint32_t modulus)
+    {
+        uint64_t result = 1;
+        uint64_t square = base;
+        for (; exponent != 0; exponent >>= 1)
+        {
+            if (exponent & 1)
+                result = result * square % modulus;
+            square = square * square % modulus;
+        }
+        return static_cast<uint32_t>(result);
+    }
+
+    /**
+     * @brief Twiddle tables of one prime: roots[h + j] = w^j for w a primitive (2h)-th root of unity.
+     */
+    struct twiddles
+    {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<uint32_t[]>> tables; // Every table ever handed out, the last one is the largest
+        unsigned log = 0;                                // The largest table covers transforms of 2^log points
+    };
+
+    static twiddles &twiddleCache(unsigned prime, bool inverse)
+    {
+        static twiddles caches[3][2];
+        return caches[prime][inverse ? 1 : 0];
+    }
+
+    /**
+     * @brief Returns a twiddle table good for transforms of up to 2^log points.
+     *
+     * Tables only grow; smaller ones stay allocated since other threads may still read them.
+     */
+    static const uint32_t *roots(unsigned prime, unsigned log, bool inverse)
+    {
+        twiddles &cache = twiddleCache(prime, inverse);
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (cache.tables.empty() || cache.log < log)
+        {
+            const uint32_t p = ntt_primes[prime];
+            size_t n = size_t(1) << log;
+            std::unique_ptr<uint32_t[]> table(new uint32_t[std::max<size_t>(n, 2)]);
+            table[0] = 0;
+            for (size_t h = 1; h < n; h *= 2)
+            {
+                uint32_t w = power(3, (p - 1) / (2 * h), p);
+                if (inverse)
+                    w = power(w, p - 2, p);
+                uint64_t value = 1;
+                for (size_t j = 0; j < h; j++)
+                {
+                    table[h + j] = static_cast<uint32_t>(value);
+                    value = value * w % p;
+                }
+            }
+            cache.tables.push_back(std::move(table));
+            cache.log = log;
+        }
+        return cache.tables.back().get();
+    }
+
+    /**
+     * @brief Runs task(begin, end) over [0, count) split into one contiguous range per thread.
+     */
+    template <typename Task>
+    static void parallelFor(size_t count, unsigned threads, const Task &task)
+    {
+        threads = static_cast<unsigned>(std::min<size_t>(std::max(1u, threads), count));
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < threads; t++)
+        {
+            workers.emplace_back([&, t]()
+                                 { task(count * t / threads, count * (t + 1) / threads); });
+        }
+        task(0, count / threads);
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+    /**
+     * @brief Smallest transform worth running on several threads.
+     */
+    static constexpr size_t parallelSize = size_t(1) << 15;
+
+    template <uint32_t P>
+    static void forwardLevels(uint32_t *a, size_t length, const uint32_t *w)
+    {
+        for (size_t len = length; len >= 2; len /= 2)
+        {
+            size_t h = len / 2;
+            for (size_t i = 0; i < length; i += len)
+            {
+                for (size_t j = 0; j < h; j++)
+                {
+                    uint32_t u = a[i + j];
+                    uint32_t v = a[i + j + h];
+                    a[i + j] = add<P>(u, v);
+                    a[i + j + h] = multiply<P>(subtract<P>(u, v), w[h + j]);
+                }
+            }
+        }
+    }
+
+    template <uint32_t P>
+    static void inverseLevels(uint32_t *a, size_t length, const uint32_t *w)
+    {
+        for (size_t len = 2; len <= length; len *= 2)
+        {
+            size_t h = len / 2;
+            for (size_t i = 0; i < length; i += len)
+            {
+                for (size_t j = 0; j < h; j++)
+                {
+                    uint32_t u = a[i + j];
+                    uint32_t v = multiply<P>(a[i + j + h], w[h + j]);
+                    a[i + j] = add<P>(u, v);
+                    a[i + j + h] = subtract<P>(u, v);
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Forward transform. The top levels, with fewer blocks than threads, split each block's
+     * butterflies; below them every thread finishes whole blocks on its own.
+     */
+    template <uint32_t P>
+    static void forwardTransform(uint32_t *a, unsigned log, const uint32_t *w, unsigned threads)
+    {
+        size_t n = size_t(1) << log;
+        if (n < parallelSize)
+            threads = 1;
+        size_t len = n;
+        for (; len >= 2 && n / len < threads; len /= 2)
+        {
+            size_t h = len / 2;
+            parallelFor(n / 2, threads, [&](size_t begin, size_t end)
+                        {
+                for (size_t t = begin; t < end; t++)
+                {
+                    size_t i = t / h * len;
+                    size_t j = t % h;
+                    uint32_t u = a[i + j];
+                    uint32_t v = a[i + j + h];
+                    a[i + j] = add<P>(u, v);
+                    a[i + j + h] = multiply<P>(subtract<P>(u, v), w[h + j]);
+                } });
+        }
+        if (len >= 2)
+        {
+            parallelFor(n / len, threads, [&](size_t begin, size_t end)
+                        {
+                for (size_t block = begin; block < end; block++)
+                    forwardLevels<P>(a + block * len, len, w); });
+        }
+    }
+
+    /**
+     * @brief Inverse transform without the final division by n, mirroring forwardTransform.
+     */
+    template <uint32_t P>
+    static void inverseTransform(uint32_t *a, unsigned log, const uint32_t *w, unsigned threads)
+    {
+        size_t n = size_t(1) << log;
+        if (n < parallelSize)
+            threads = 1;
+        size_t len = n;
+        while (len >= 2 && n / len < threads)
+            len /= 2;
+        if (len >= 2)
+        {
+            parallelFor(n / len, threads, [&](size_t begin, size_t end)
+                        {
+                for (size_t block = begin; block < end; block++)
+                    inverseLevels<P>(a + block * len, len, w); });
+        }
+        for (len *= 2; len <= n; len *= 2)
+        {
+            size_t h = len / 2;
+            parallelFor(n / 2, threads, [&](size_t begin, size_t end)
+                        {
+                for (size_t t = begin; t < end; t++)
+                {
+                    size_t i = t / h * len;
+                    size_t j = t % h;
+                    uint32_t u = a[i + j];
+                    uint32_t v = multiply<P>(a[i + j + h], w[h + j]);
+                    a[i + j] = add<P>(u, v);
+                    a[i + j + h] = subtract<P>(u, v);
+                } });
+        }
+    }
+
+    template <uint32_t P>
+    static void pointwiseScaled(uint32_t *a, const uint32_t *b, unsigned log)
+    {
+        size_t n = size_t(1) << log;
+        uint32_t scale = power(static_cast<uint32_t>(n % P), P - 2, P);
+        for (size_t i = 0; i < n; i++)
+            a[i] = multiply<P>(multiply<P>(a[i], b[i]), scale);
+    }
+
+public:
+    /**
+     * @brief Picks the primes and transform size of a convolution.
+     *
+     * @param bound Upper bound on every coefficient of the result.
+     * @param length Number of coefficients of the result.
+     * @param plan Receives the plan.
+     * @return False if no combination of primes is both large enough and long enough.
+     */
+    static bool make_plan(uint64_t bound, size_t length, ntt_plan &plan)
+    {
+        unsigned log = 0;
+        while ((size_t(1) << log) < length)
+            log++;
+        // candidate prime sets, cheapest first
+        static const unsigned sets[5][3] = {{0}, {1}, {0, 1}, {1, 2}, {0, 1, 2}};
+        static const unsigned sizes[5] = {1, 1, 2, 2, 3};
+        for (size_t s = 0; s < 5; s++)
+        {
+            long double product = 1;
+            unsigned maxLog = 64;
+            for (unsigned i = 0; i < sizes[s]; i++)
+            {
+                product *= ntt_primes[sets[s][i]];
+                maxLog = std::min(maxLog, ntt_max_log[sets[s][i]]);
+            }
+            if (product > static_cast<long double>(bound) && log <= maxLog)
+            {
+                plan.log = log;
+                plan.prime_count = sizes[s];
+                std::copy(sets[s], sets[s] + 3, plan.primes);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Transforms 2^log residues in place, modulo ntt_primes[prime].
+     */
+    static void forward(unsigned prime, uint32_t *data, unsigned log, unsigned threads)
+    {
+        const uint32_t *w = roots(prime, log, false);
+        switch (prime)
+        {
+        case 0:
+            forwardTransform<ntt_primes[0]>(data, log, w, threads);
+            break;
+        case 1:
+            forwardTransform<ntt_primes[1]>(data, log, w, threads);
+            break;
+        default:
+            forwardTransform<ntt_primes[2]>(data, log, w, threads);
+            break;
+        }
+    }
+
+    /**
+     * @brief Multiplies two transforms pointwise into the first, divided by the transform size.
+     */
+    static void pointwise(unsigned prime, uint32_t *a, const uint32_t *b, unsigned log)
+    {
+        switch (prime)
+        {
+        case 0:
+            pointwiseScaled<ntt_primes[0]>(a, b, log);
+            break;
+        case 1:
+            pointwiseScaled<ntt_primes[1]>(a, b, log);
+            break;
+        default:
+            pointwiseScaled<ntt_primes[2]>(a, b, log);
+            break;
+        }
+    }
+
+    /**
+     * @brief Inverse transform in place. The division by the size happens in pointwise().
+     */
+    static void inverse(unsigned prime, uint32_t *data, unsigned log, unsigned threads)
+    {
+        const uint32_t *w = roots(prime, log, true);
+        switch (prime)
+        {
+        case 0:
+            inverseTransform<ntt_primes[0]>(data, log, w, threads);
+            break;
+        case 1:
+            inverseTransform<ntt_primes[1]>(data, log, w, threads);
+            break;
+        default:
+            inverseTransform<ntt_primes[2]>(data, log, w, threads);
+            break;
+        }
+    }
+
+    /**
+     * @brief Combines the residues of one coefficient with Garner's algorithm.
+     *
+     * @param plan The plan whose primes the residues belong to.
+     * @param residues One residue per prime of the plan.
+     * @return The coefficient, exact if it is below both 2^64 and the product of the primes.
+     */
+    static uint64_t combine(const ntt_plan &plan, const uint32_t *residues)
+    {
+        uint64_t p0 = ntt_primes[plan.primes[0]];
+        uint64_t x0 = residues[0];
+        if (plan.prime_count == 1)
+            return x0;
+        uint64_t p1 = ntt_primes[plan.primes[1]];
+        // x = x0 + p0 * t1 with t1 = (r1 - x0) / p0 mod p1
+        uint64_t t1 = (residues[1] + p1 - x0 % p1) % p1 * power(static_cast<uint32_t>(p0 % p1), p1 - 2, static_cast<uint32_t>(p1)) % p1;
+        uint64_t x1 = x0 + p0 * t1;
+        if (plan.prime_count == 2)
+            return x1;
+        uint64_t p2 = ntt_primes[plan.primes[2]];
+        uint64_t p01 = p0 * p1 % p2;
+        uint64_t t2 = (residues[2] + p2 - x1 % p2) % p2 * power(static_cast<uint32_t>(p01), p2 - 2, static_cast<uint32_t>(p2)) % p2;
+        return x1 + p0 * p1 * t2; // wraps modulo 2^64, exact when the true value fits
+    }
+};
@@ -0,0 +1,325 @@
+/**
+ * @file prime_sieve.hpp
+ * @brief This file contains a segmented sieve of Eratosthenes with a mod-30 wheel, shared by the
+ * number-theoretic routines.
+ *
+ * Only numbers coprime to 30 are stored, one bit each, so a byte covers 30 consecutive integers.
+ * The range is sieved in segments of 32 KiB, which stay in the L1 cache, and each segment is
+ * sieved from scratch using only the base primes up to sqrt(high). Segments are therefore
+ * independent: they can be handed to different threads, or produced lazily by an iterator.
+ *
+ * @version 1.0
+ * @date 2026-10-18
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <iterator>
+#include <thread>
+#include <vector>
+#include "bigint.hpp"
+
+/**
+ * @class prime_sieve
+ * @brief The primes of a range [low, high], listed, counted or iterated in increasing order.
+ */
+class prime_sieve
+{
+public:
+    static constexpr size_t segment_bytes = 32768;              // Bytes sieved at a time
+    static constexpr uint64_t segment_span = 30 * segment_bytes; // Integers covered by one segment
+
+private:
+    uint64_t low_bound;
+    uint64_t high_bound;
+    std::vector<uint64_t> base_primes; // Primes from 7 up to sqrt(high)
+
+    static constexpr uint8_t residues[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+
+    /**
+     * @brief Returns the bit of a residue modulo 30 that is coprime to 30.
+     */
+    static unsigned bitOf(uint64_t residue)
+    {
+        switch (residue)
+        {
+        case 1:
+            return 0;
+        case 7:
+            return 1;
+        case 11:
+            return 2;
+        case 13:
+            return 3;
+        case 17:
+            return 4;
+        case 19:
+            return 5;
+        case 23:
+            return 6;
+        default:
+            return 7;
+        }
+    }
+
+    static uint64_t isqrt(uint64_t n)
+    {
+        uint64_t root = static_cast<uint64_t>(std::sqrt(static_cast<double>(n)));
+        while (root > 0 && root * root > n)
+            root--;
+        while ((root + 1) * (root + 1) <= n)
+            root++;
+        return root;
+    }
+
+    uint64_t firstSegment() const
+    {
+        return low_bound / segment_span;
+    }
+
+    uint64_t lastSegment() const
+    {
+        return high_bound / segment_span;
+    }
+
+    /**
+     * @brief Sieves one segment and appends its primes within [low, high] to out.
+     *
+     * @param segment Index of the segment, covering [segment * segment_span, (segment + 1) * segment_span).
+     * @param out Receives the primes in increasing order.
+     */
+    void sieveSegment(uint64_t segment, std::vector<uint64_t> &out) const
+    {
+        const uint64_t base = segment * segment_span;
+        const uint64_t end = std::min(base + segment_span, high_bound + 1);
+        const size_t bytes = static_cast<size_t>((end - base + 29) / 30);
+        std::vector<uint8_t> composite(bytes, 0);
+
+        for (uint64_t p : base_primes)
+        {
+            if (p * p >= end)
+                break;
+            // cross off p * q for q >= p coprime to 30; q = r (mod 30) gives bytes p apart, same bit
+            uint64_t qMin = std::max(p, (base + p - 1) / p);
+            for (uint8_t r : residues)
+            {
+                uint64_t q = qMin + (r + 30 - qMin % 30) % 30;
+                uint64_t multiple = p * q;
+                if (multiple >= end)
+                    continue;
+                uint8_t mask = static_cast<uint8_t>(1u << bitOf(multiple % 30));
+                for (uint64_t index = (multiple - base) / 30; index < bytes; index += p)
+                    composite[index] |= mask;
+            }
+        }
+
+        if (base == 0)
+        {
+            composite[0] |= 1; // 1 is not prime
+            for (uint64_t p : {2, 3, 5})
+            {
+                if (p >= low_bound && p <= high_bound)
+                    out.push_back(p);
+            }
+        }
+        for (size_t index = 0; index < bytes; index++)
+        {
+            uint8_t candidates = static_cast<uint8_t>(~composite[index]);
+            while (candidates != 0)
+            {
+                unsigned bit = 0;
+                while (((candidates >> bit) & 1) == 0)
+                    bit++;
+                candidates = static_cast<uint8_t>(candidates & (candidates - 1));
+                uint64_t value = base + 30 * index + residues[bit];
+                if (value >= low_bound && value <= high_bound)
+                    out.push_back(value);
+            }
+        }
+    }
+
+    /**
+     * @brief Runs task(first, last, thread) on contiguous blocks of segments, one per thread.
+     */
+    template <typename Task>
+    void forSegmentBlocks(unsigned threads, const Task &task) const
+    {
+        uint64_t segments = lastSegment() - firstSegment() + 1;
+        unsigned count = static_cast<unsigned>(std::min<uint64_t>(threads != 0 ? threads : bigint::max_threads(), segments));
+        std::vector<std::thread> workers;
+        for (unsigned t = 1; t < count; t++)
+        {
+            workers.emplace_back([&, t]()
+                                 { task(firstSegment() + segments * t / count, firstSegment() + segments * (t + 1) / count, t); });
+        }
+        task(firstSegment(), firstSegment() + segments / count, 0u);
+        for (std::thread &worker : workers)
+            worker.join();
+    }
+
+public:
+    /**
+     * @class iterator
+     * @brief Input iterator over the primes of the range, sieving one segment at a time.
+     */
+    class iterator
+    {
+    private:
+        const prime_sieve *sieve = nullptr; // Null at the end
+        uint64_t segment = 0;
+        std::vector<uint64_t> buffer;
+        size_t position = 0;
+
+        // moves to the next non-empty segment, or to the end
+        void fill()
+        {
+            while (position == buffer.size())
+            {
+                if (segment > sieve->lastSegment() || sieve->low_bound > sieve->high_bound)
+                {
+                    sieve = nullptr;
+                    return;
+                }
+                buffer.clear();
+                position = 0;
+                sieve->sieveSegment(segment++, buffer);
+            }
+        }
+
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = uint64_t;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const uint64_t *;
+        using reference = const uint64_t &;
+
+        iterator() = default;
+
+        explicit iterator(const prime_sieve &owner) : sieve(&owner), segment(owner.firstSegment())
+        {
+            fill();
+        }
+
+        reference operator*() const
+        {
+            return buffer[position];
+        }
+
+        iterator &operator++()
+        {
+            position++;
+            fill();
+            return *this;
+        }
+
+        iterator operator++(int)
+        {
+            iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const iterator &other) const
+        {
+            return sieve == other.sieve && (sieve == nullptr || (segment == other.segment && position == other.position));
+        }
+
+        bool operator!=(const iterator &other) const
+        {
+            return !(*this == other);
+        }
+    };
+
+    /**
+     * @brief Prepares a sieve of the primes in [low, high].
+     *
+     * Only the base primes up to sqrt(high) are computed here; the range itself is sieved on use.
+     *
+     * @param high Inclusive upper bound, at most about 10^18.
+     * @param low Inclusive lower bound.
+     */
+    explicit prime_sieve(uint64_t high, uint64_t low = 0) : low_bound(low), high_bound(high)
+    {
+        uint64_t root = isqrt(high);
+        std::vector<char> composite(root + 1, 0);
+        for (uint64_t i = 2; i <= root; i++)
+        {
+            if (composite[i])
+                continue;
+            if (i >= 7)
+                base_primes.push_back(i);
+            for (uint64_t j = i * i; j <= root; j += i)
+                composite[j] = 1;
+        }
+    }
+
+    uint64_t low() const
+    {
+        return low_bound;
+    }
+
+    uint64_t high() const
+    {
+        return high_bound;
+    }
+
+    iterator begin() const
+    {
+        return iterator(*this);
+    }
+
+    iterator end() const
+    {
+        return iterator();
+    }
+
+    /**
+     * @brief Lists the primes of the range.
+     *
+     * @param threads Number of threads sieving segments, 0 means bigint::max_threads().
+     * @return The primes in increasing order.
+     */
+    std::vector<uint64_t> primes(unsigned threads = 0) const
+    {
+        if (low_bound > high_bound)
+            return {};
+        std::vector<std::vector<uint64_t>> blocks(std::max(1u, threads != 0 ? threads : bigint::max_threads()));
+        forSegmentBlocks(threads, [&](uint64_t first, uint64_t last, unsigned t)
+                         {
+            for (uint64_t segment = first; segment < last; segment++)
+                sieveSegment(segment, blocks[t]); });
+        std::vector<uint64_t> result;
+        for (std::vector<uint64_t> &block : blocks)
+            result.insert(result.end(), block.begin(), block.end());
+        return result;
+    }
+
+    /**
+     * @brief Counts the primes of the range.
+     *
+     * @param threads Number of threads sieving segments, 0 means bigint::max_threads().
+     * @return The number of primes in [low, high].
+     */
+    uint64_t count(unsigned threads = 0) const
+    {
+        if (low_bound > high_bound)
+            return 0;
+        std::vector<uint64_t> counts(std::max(1u, threads != 0 ? threads : bigint::max_threads()), 0);
+        forSegmentBlocks(threads, [&](uint64_t first, uint64_t last, unsigned t)
+                         {
+            std::vector<uint64_t> buffer;
+            for (uint64_t segment = first; segment < last; segment++)
+            {
+                buffer.clear();
+                sieveSegment(segment, buffer);
+                counts[t] += buffer.size();
+            } });
+        uint64_t total = 0;
+        for (uint64_t c : counts)
+            total += c;
+        return total;
+    }
+};
@@ -0,0 +1,211 @@
+/**
+ * @file replay.cpp
+ * @brief Replays a bigint operation trace and reports throughput and latency percentiles.
+ *
+ * Traces are written by bigint_trace_recorder. Operands are rebuilt from the recorded values
+ * when present, otherwise random operands of the recorded sizes and signs are generated.
+ *
+ * Usage: ./replay trace.bin [threads] [repeat]
+ *   threads  number of threads replaying the trace, each taking every n-th operation (default 1)
+ *   repeat   number of passes over the trace (default 1)
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "bigint.hpp"
+#include "bigint_trace.hpp"
+
+/**
+ * @brief An operation ready to be executed.
+ */
+struct replayOperation
+{
+    bigint_op op;
+    bigint lhs;
+    bigint rhs;
+};
+
+/**
+ * @brief Builds a random decimal number with the given digit count and sign.
+ *
+ * @param digitCount Number of digits.
+ * @param negative Whether the number is negative.
+ * @param state State of the xorshift generator.
+ * @return The number.
+ */
+bigint randomOperand(size_t digitCount, bool negative, uint64_t &state)
+{
+    std::string text = negative ? "-" : "";
+    for (size_t i = 0; i < digitCount; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int digit = static_cast<int>(state % 10);
+        // no leading zero, the recorded size must be kept
+        if (i == 0 && digitCount > 1 && digit == 0)
+            digit = 1;
+        text.push_back(static_cast<char>('0' + digit));
+    }
+    return bigint(text);
+}
+
+/**
+ * @brief Executes one operation and keeps the result alive so that it is not optimized away.
+ *
+ * @return The digit count of the result.
+ */
+size_t execute(const replayOperation &operation)
+{
+    switch (operation.op)
+    {
+    case bigint_op::add:
+        return (operation.lhs + operation.rhs).digit_count();
+    case bigint_op::subtract:
+        return (operation.lhs - operation.rhs).digit_count();
+    case bigint_op::multiply:
+        return (operation.lhs * operation.rhs).digit_count();
+    case bigint_op::divide:
+        return (operation.lhs / operation.rhs).digit_count();
+    case bigint_op::modulo:
+        return (operation.lhs % operation.rhs).digit_count();
+    }
+    return 0;
+}
+
+/**
+ * @brief Prints the count and latency percentiles of a set of samples.
+ *
+ * @param name Label of the row.
+ * @param samples Latencies in nanoseconds, sorted in place.
+ */
+void printPercentiles(const std::string &name, std::vector<uint64_t> &samples)
+{
+    if (samples.empty())
+    {
+        return;
+    }
+    std::sort(samples.begin(), samples.end());
+    auto at = [&](double q)
+    {
+        return samples[std::min(samples.size() - 1, static_cast<size_t>(q * static_cast<double>(samples.size())))];
+    };
+    std::cout << std::setw(10) << name << std::setw(12) << samples.size() << std::setw(12) << at(0.5)
+              << std::setw(12) << at(0.9) << std::setw(12) << at(0.99) << std::setw(12) << at(0.999)
+              << std::setw(12) << samples.back() << "\n";
+}
+
+/**
+ * @brief Loads a trace, replays it and prints the report.
+ *
+ * @param argc Argument count.
+ * @param argv Arguments: trace file, optional thread count and repeat count.
+ * @return Returns 0 on success, 1 on bad usage or an unreadable trace.
+ */
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " trace.bin [threads] [repeat]" << std::endl;
+        return 1;
+    }
+    unsigned threadCount = argc > 2 ? static_cast<unsigned>(std::max(1L, std::strtol(argv[2], nullptr, 10))) : 1;
+    unsigned repeat = argc > 3 ? static_cast<unsigned>(std::max(1L, std::strtol(argv[3], nullptr, 10))) : 1;
+
+    std::vector<replayOperation> operations;
+    try
+    {
+        bigint_trace_reader reader(argv[1]);
+        bigint_trace_record record;
+        uint64_t state = 88172645463325252ULL;
+        while (reader.next(record))
+        {
+            replayOperation operation{record.op, bigint(), bigint()};
+            if (reader.values_recorded())
+            {
+                operation.lhs = bigint((record.lhs_negative ? "-" : "") + record.lhs_value);
+                if (record.has_rhs)
+                    operation.rhs = bigint((record.rhs_negative ? "-" : "") + record.rhs_value);
+            }
+            else
+            {
+                operation.lhs = randomOperand(record.lhs_digits, record.lhs_negative, state);
+                if (record.has_rhs)
+                    operation.rhs = randomOperand(record.rhs_digits, record.rhs_negative, state);
+            }
+            // a generated divisor can come out as zero
+            if ((operation.op == bigint_op::divide || operation.op == bigint_op::modulo) && operation.rhs == bigint())
+                operation.rhs = bigint(1);
+            operations.push_back(std::move(operation));
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Cannot read trace: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // thread t replays operations t, t + threadCount, t + 2 * threadCount, ...
+    std::vector<std::vector<uint64_t>> latencies(threadCount);
+    std::vector<size_t> sinks(threadCount, 0);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (unsigned t = 0; t < threadCount; t++)
+    {
+        threads.emplace_back([&, t]()
+                             {
+            for (unsigned pass = 0; pass < repeat; pass++)
+            {
+                for (size_t i = t; i < operations.size(); i += threadCount)
+                {
+                    auto begin = std::chrono::steady_clock::now();
+                    sinks[t] += execute(operations[i]);
+                    auto end = std::chrono::steady_clock::now();
+                    latencies[t].push_back(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count()));
+                }
+            } });
+    }
+    for (std::thread &thread : threads)
+    {
+        thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    size_t executed = operations.size() * repeat;
+    std::cout << "Replayed " << executed << " operations on " << threadCount << " thread(s) in "
+              << std::fixed << std::setprecision(4) << elapsed.count() << " s ("
+              << std::setprecision(0) << executed / elapsed.count() << " ops/s)\n\n";
+    std::cout << "Latency (ns)\n";
+    std::cout << std::setw(10) << "op" << std::setw(12) << "count" << std::setw(12) << "p50" << std::setw(12) << "p90"
+              << std::setw(12) << "p99" << std::setw(12) << "p99.9" << std::setw(12) << "max" << "\n";
+
+    // per operation, then all together
+    std::vector<uint64_t> all;
+    for (size_t opIndex = 0; opIndex < bigint_op_count; opIndex++)
+    {
+        bigint_op op = static_cast<bigint_op>(opIndex);
+        std::vector<uint64_t> samples;
+        for (unsigned t = 0; t < threadCount; t++)
+        {
+            size_t k = 0;
+            for (unsigned pass = 0; pass < repeat; pass++)
+            {
+                for (size_t i = t; i < operations.size(); i += threadCount, k++)
+                {
+                    if (operations[i].op == op)
+                        samples.push_back(latencies[t][k]);
+                }
+            }
+        }
+        all.insert(all.end(), samples.begin(), samples.end());
+        printPercentiles(bigint_op_name(op), samples);
+    }
+    printPercentiles("all", all);
+    return 0;
+}
@@ -0,0 +1,259 @@
+/**
+ * @file rsa_benchmark.cpp
+ * @brief End-to-end RSA workload on bigint: key generation, CRT signing and verification.
+ *
+ * Everything runs on bigint and modular.hpp; no external crypto library is used. Primes are found
+ * by an incremental search: candidates are screened against the small primes of prime_sieve by
+ * updating their residues, and survivors are tested with Miller-Rabin. Signatures use the Chinese
+ * remainder theorem and every signature is verified.
+ *
+ * This is a benchmark, not a secure implementation: the random generator is a seeded Mersenne
+ * twister and there is no padding or side-channel protection.
+ *
+ * Usage: ./rsa_benchmark [bits...] [-n operations]
+ *   bits        key sizes to run (default 2048 3072 4096)
+ *   operations  signatures and verifications timed per key size (default 10)
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "bigint.hpp"
+#include "modular.hpp"
+#include "prime_sieve.hpp"
+
+/**
+ * @brief Time spent in each phase, in seconds.
+ */
+struct phaseTimes
+{
+    double screening = 0;    // Updating small-prime residues of candidates
+    double miller_rabin = 0; // Primality tests of candidates that passed screening
+    double assembly = 0;     // Computing n, d and the CRT exponents
+    double half_powers = 0;  // The two half-size exponentiations of signing
+    double recombine = 0;    // Garner recombination of the two halves
+    double verify = 0;       // Public exponentiations
+};
+
+/**
+ * @brief An RSA key with its CRT parameters.
+ */
+struct rsaKey
+{
+    bigint n, e, d, p, q, dp, dq, qinv;
+};
+
+using clockType = std::chrono::steady_clock;
+
+double secondsSince(clockType::time_point start)
+{
+    return std::chrono::duration<double>(clockType::now() - start).count();
+}
+
+/**
+ * @brief Returns 2^exponent.
+ */
+bigint powerOfTwo(size_t exponent)
+{
+    bigint result(1);
+    bigint square(2);
+    for (; exponent != 0; exponent /= 2)
+    {
+        if (exponent % 2 == 1)
+            result *= square;
+        square *= square;
+    }
+    return result;
+}
+
+/**
+ * @brief Returns a uniformly random number in [low, low + span).
+ */
+bigint randomBelow(const bigint &low, const bigint &span, std::mt19937_64 &random)
+{
+    std::string text;
+    while (text.size() < span.digit_count() + 20)
+    {
+        text += std::to_string(random() % 10000000000000000000ULL);
+    }
+    return low + bigint(text) % span;
+}
+
+/**
+ * @brief Finds a random prime of exactly the given bit length with p - 1 coprime to e.
+ *
+ * @param bits Bit length of the prime.
+ * @param e The public exponent.
+ * @param smallPrimes Odd primes used to screen candidates.
+ * @param random Random generator.
+ * @param times Receives the screening and Miller-Rabin times.
+ * @return The prime.
+ */
+bigint randomPrime(size_t bits, const bigint &e, const std::vector<uint64_t> &smallPrimes, std::mt19937_64 &random, phaseTimes &times)
+{
+    const bigint top = powerOfTwo(bits - 1);
+    while (true)
+    {
+        // odd start with the top bit set; then walk candidate, candidate + 2, ...
+        bigint candidate = randomBelow(top, top, random);
+        if (modular_kernels::remainder(candidate, 2) == 0)
+            candidate += bigint(1);
+
+        auto start = clockType::now();
+        std::vector<uint64_t> residues(smallPrimes.size());
+        for (size_t i = 0; i < smallPrimes.size(); i++)
+            residues[i] = modular_kernels::remainder(candidate, smallPrimes[i]);
+        times.screening += secondsSince(start);
+
+        for (uint64_t offset = 0; offset < 100000; offset += 2)
+        {
+            start = clockType::now();
+            bool divisible = false;
+            for (size_t i = 0; i < smallPrimes.size() && !divisible; i++)
+                divisible = (residues[i] + offset) % smallPrimes[i] == 0;
+            times.screening += secondsSince(start);
+            if (divisible)
+                continue;
+
+            bigint value = candidate + bigint(static_cast<int64_t>(offset));
+            if (value >= top + top)
+                break;
+            start = clockType::now();
+            bool prime = is_probable_prime(value);
+            times.miller_rabin += secondsSince(start);
+            if (prime && gcd(value - bigint(1), e) == bigint(1))
+                return value;
+        }
+    }
+}
+
+/**
+ * @brief Generates an RSA key with public exponent 65537.
+ */
+rsaKey generateKey(size_t bits, const std::vector<uint64_t> &smallPrimes, std::mt19937_64 &random, phaseTimes &times)
+{
+    rsaKey key;
+    key.e = bigint(65537);
+    do
+    {
+        key.p = randomPrime(bits / 2, key.e, smallPrimes, random, times);
+        key.q = randomPrime(bits - bits / 2, key.e, smallPrimes, random, times);
+    } while (key.p == key.q);
+    if (key.p < key.q)
+        std::swap(key.p, key.q);
+
+    auto start = clockType::now();
+    key.n = key.p * key.q;
+    bigint pMinusOne = key.p - bigint(1);
+    bigint qMinusOne = key.q - bigint(1);
+    bigint lambda = pMinusOne / gcd(pMinusOne, qMinusOne) * qMinusOne;
+    key.d = mod_inverse(key.e, lambda);
+    key.dp = key.d % pMinusOne;
+    key.dq = key.d % qMinusOne;
+    key.qinv = mod_inverse(key.q, key.p);
+    times.assembly += secondsSince(start);
+    return key;
+}
+
+/**
+ * @brief Runs the workload for one key size and prints the report.
+ *
+ * @param bits Modulus size in bits.
+ * @param operations Number of signatures and verifications to time.
+ * @param smallPrimes Odd primes used to screen prime candidates.
+ * @return False if a signature failed to verify.
+ */
+bool runKeySize(size_t bits, size_t operations, const std::vector<uint64_t> &smallPrimes)
+{
+    std::mt19937_64 random(bits);
+    phaseTimes times;
+
+    auto start = clockType::now();
+    rsaKey key = generateKey(bits, smallPrimes, random, times);
+    double keygen = secondsSince(start);
+
+    montgomery modP(key.p);
+    montgomery modQ(key.q);
+    montgomery modN(key.n);
+    std::vector<bigint> messages;
+    for (size_t i = 0; i < operations; i++)
+        messages.push_back(randomBelow(bigint(), key.n, random));
+
+    bool ok = true;
+    std::vector<bigint> signatures;
+    start = clockType::now();
+    for (const bigint &message : messages)
+    {
+        auto phase = clockType::now();
+        bigint m1 = powmod(modP, message, key.dp);
+        bigint m2 = powmod(modQ, message, key.dq);
+        times.half_powers += secondsSince(phase);
+
+        phase = clockType::now();
+        bigint h = reduce_mod(key.qinv * (m1 - m2), key.p);
+        signatures.push_back(m2 + h * key.q);
+        times.recombine += secondsSince(phase);
+    }
+    double sign = secondsSince(start);
+
+    start = clockType::now();
+    for (size_t i = 0; i < operations; i++)
+        ok &= powmod(modN, signatures[i], key.e) == messages[i];
+    double verify = secondsSince(start);
+    times.verify = verify;
+
+    std::cout << "RSA-" << bits << " (" << key.n.digit_count() << "-digit modulus)\n";
+    std::cout << "  key generation     " << keygen << " s\n";
+    std::cout << "    screening        " << times.screening << " s\n";
+    std::cout << "    Miller-Rabin     " << times.miller_rabin << " s\n";
+    std::cout << "    key assembly     " << times.assembly << " s\n";
+    std::cout << "  sign (CRT)         " << operations / sign << " ops/s\n";
+    std::cout << "    half powers      " << times.half_powers << " s\n";
+    std::cout << "    recombination    " << times.recombine << " s\n";
+    std::cout << "  verify (e = 65537) " << operations / verify << " ops/s" << (ok ? "" : " (VERIFICATION FAILED)") << "\n"
+              << std::endl;
+    return ok;
+}
+
+/**
+ * @brief Runs the RSA workload for the requested key sizes.
+ *
+ * @param argc Argument count.
+ * @param argv Arguments: key sizes in bits, and -n followed by the operation count.
+ * @return Returns 0 on success, 1 if a signature did not verify or on bad usage.
+ */
+int main(int argc, char *argv[])
+{
+    std::vector<size_t> sizes;
+    size_t operations = 10;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string argument = argv[i];
+        if (argument == "-n" && i + 1 < argc)
+        {
+            operations = std::max<size_t>(1, std::strtoull(argv[++i], nullptr, 10));
+            continue;
+        }
+        size_t bits = std::strtoull(argv[i], nullptr, 10);
+        if (bits < 64)
+        {
+            std::cerr << "Usage: " << argv[0] << " [bits...] [-n operations]" << std::endl;
+            return 1;
+        }
+        sizes.push_back(bits);
+    }
+    if (sizes.empty())
+        sizes = {2048, 3072, 4096};
+
+    // odd primes below 2^16 screen out about 90% of candidates before Miller-Rabin
+    std::vector<uint64_t> smallPrimes = prime_sieve(65536, 3).primes(1);
+    std::cout << std::fixed << std::setprecision(4);
+    bool ok = true;
+    for (size_t bits : sizes)
+        ok &= runKeySize(bits, operations, smallPrimes);
+    return ok ? 0 : 1;
+}
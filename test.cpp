@@ -13,7 +13,20 @@
 #include <random>
 #include <string>
 #include <limits>
+#include <cmath>
+#include <iterator>
+#include <thread>
+#include <vector>
 #include "bigint.hpp"
+#include "concurrent_bigint_counter.hpp"
+#include "bigint_trace.hpp"
+#include "bigint_histogram.hpp"
+#include "bigint_array.hpp"
+#include "bigint_sort.hpp"
+#include "modular.hpp"
+#include "factor.hpp"
+#include "prime_sieve.hpp"
+#include <cstdio>
 
 /**
  * @var successCount
@@ -174,6 +187,15 @@ void testBigInt()
         testSuccess("Comparison", a < b && a <= b && b > a && b >= a && a != b && !(a == b));
     }
 
+    // Comparison and subtraction of negative numbers of different lengths
+    {
+        bigint a("-100");
+        bigint b("-5");
+        std::ostringstream oss;
+        oss << a - b << " " << b - a;
+        testSuccess("Negative comparison", a < b && !(b < a) && b > a && oss.str() == "-95 95");
+    }
+
     // Increment (++, both pre-increment and post-increment)
     {
         bigint a("999");
@@ -281,6 +303,539 @@ void testBigInt()
         std::cerr << "Error during large number operations: " << e.what() << std::endl;
         testSuccess("Test large number operations", false);
     }
+
+    // Parallel decimal conversion round trip
+    try
+    {
+        bigint::set_max_threads(4);
+        std::string text = "-9";
+        for (int i = 0; i < 300000; i++)
+        {
+            text.push_back(static_cast<char>('0' + (i * 7) % 10));
+        }
+        bigint a(text);
+        testSuccess("Parallel to_string", a.to_string() == text);
+
+        std::string bad = text;
+        bad[250000] = 'x';
+        bool thrown = false;
+        try
+        {
+            bigint b(bad);
+        }
+        catch (const std::invalid_argument &e)
+        {
+            thrown = std::string(e.what()) == "Invalid digit in string";
+        }
+        testSuccess("Parallel string parsing rejects invalid digit", thrown);
+        bigint::set_max_threads(0);
+    }
+    catch (const std::exception &e)
+    {
+        testSuccess("Parallel decimal conversion", false);
+    }
+
+    // Non-throwing parsing reports the first invalid character
+    {
+        bigint a;
+        size_t ok = bigint::parse("-000123456789012345678901234567890", a);
+        size_t colon = bigint::parse("1234567890123456789:1234", a);
+        size_t slash = bigint::parse("12345678901234567890123/", a);
+        size_t high = bigint::parse(std::string("12\xb0" "4"), a);
+        size_t sign = bigint::parse("-", a);
+        testSuccess("Parse with error position", ok == std::string::npos && a.to_string() == "-123456789012345678901234567890" &&
+                                                   colon == 19 && slash == 23 && high == 2 && sign == 1);
+    }
+
+    // Stream output of numbers whose length is not a multiple of the 16-digit block
+    {
+        bool ok = true;
+        for (size_t length = 1; length <= 40; length++)
+        {
+            std::string text = "-";
+            for (size_t i = 0; i < length; i++)
+            {
+                text.push_back(static_cast<char>('1' + (i * 5) % 9));
+            }
+            std::ostringstream oss;
+            oss << bigint(text);
+            ok &= oss.str() == text;
+        }
+        testSuccess("Stream output of all lengths", ok);
+    }
+
+    // Formatting with width, fill, alignment, sign, radix and digit grouping
+    {
+        auto format = [](const bigint &value, const std::string &specText)
+        {
+            bigint::format_spec spec;
+            bigint::parse_format_spec(specText.data(), specText.data() + specText.size(), spec);
+            std::string out;
+            value.format_to(std::back_inserter(out), spec);
+            return out;
+        };
+        testSuccess("Format width and alignment", format(bigint(12345), ">10") == "     12345" &&
+                                                       format(bigint(-42), "*^11") == "****-42****" &&
+                                                       format(bigint(7), "<3") == "7  ");
+        testSuccess("Format sign and zero padding", format(bigint(1234567), "+,") == "+1,234,567" &&
+                                                         format(bigint(-123), "010") == "-000000123" &&
+                                                         format(bigint(5), " ") == " 5");
+        testSuccess("Format radix", format(bigint(255), "#x") == "0xff" && format(bigint(5), "#b") == "0b101" &&
+                                        format(bigint(8), "o") == "10" && format(bigint("3735928559"), "X") == "DEADBEEF" &&
+                                        format(bigint("-4294967296"), "_x") == "-1_0000_0000" &&
+                                        format(bigint(0), "b") == "0");
+#ifdef __cpp_lib_format
+        testSuccess("std::format", std::format("{:>+12,}", bigint(1234567)) == "  +1,234,567" &&
+                                       std::format("{:#x}", bigint(255)) == "0xff");
+#endif
+    }
+
+    // Trace recording and reading back
+    try
+    {
+        const std::string path = "test_trace.bin";
+        {
+            bigint_trace_recorder recorder(path, true);
+            bigint a("-123456789");
+            bigint b("98765");
+            bigint c = a * b;
+            c += a; // different signs: reported once as an addition
+            c -= bigint(7);
+        }
+        bigint x = bigint(1) + bigint(2); // not recorded
+
+        bigint_trace_reader reader(path);
+        std::vector<bigint_trace_record> records;
+        bigint_trace_record record;
+        while (reader.next(record))
+        {
+            records.push_back(record);
+        }
+        std::remove(path.c_str());
+        testSuccess("Trace record and read", reader.values_recorded() && records.size() == 3 &&
+                                                 records[0].op == bigint_op::multiply && records[0].lhs_negative &&
+                                                 records[0].lhs_value == "123456789" && records[0].rhs_value == "98765" &&
+                                                 records[1].op == bigint_op::add && records[1].lhs_digits == 14 &&
+                                                 records[2].op == bigint_op::subtract && records[2].rhs_value == "7");
+    }
+    catch (const std::exception &e)
+    {
+        testSuccess("Trace record and read", false);
+    }
+
+    // Latency histograms per operation and size class
+    try
+    {
+        bool bucketsOk = true;
+        for (uint64_t v = 0; v < 5000000; v = v * 5 / 4 + 1)
+        {
+            uint64_t upper = bigint_latency_histogram::bucket_upper_bound(bigint_latency_histogram::bucket_index(v));
+            bucketsOk &= upper >= v && upper - v <= v / 8;
+        }
+
+        bigint_latency_histogram histogram;
+        bigint a(std::string(40, '9'));
+        for (int i = 0; i < 100; i++)
+        {
+            bigint b = a * a; // 40 digits: size class 5
+            b = b - a;        // 80 digits: size class 6
+        }
+        std::vector<bigint_latency_histogram::series> series = histogram.snapshot();
+        bool seriesOk = series.size() == 2 && series[0].op == bigint_op::subtract && series[0].size_class == 6 &&
+                        series[0].count == 100 && series[1].op == bigint_op::multiply && series[1].size_class == 5 &&
+                        series[1].count == 100 && series[1].percentile(0.5) <= series[1].percentile(0.99);
+        std::string json = histogram.to_json();
+        std::string prometheus = histogram.to_prometheus();
+        bool exportOk = json.find("\"op\":\"multiply\",\"digits\":\"32-63\",\"count\":100") != std::string::npos &&
+                        prometheus.find("bigint_operation_duration_seconds_count{op=\"subtract\",digits=\"64-127\"} 100") != std::string::npos;
+        testSuccess("Latency histogram", bucketsOk && seriesOk && exportOk);
+    }
+    catch (const std::exception &e)
+    {
+        testSuccess("Latency histogram", false);
+    }
+
+    // Flat array of bigints: views, arithmetic, sort and serialization
+    try
+    {
+        std::vector<bigint> values = {bigint(42), bigint("-123456789012345678901234567890"), bigint(0),
+                                      bigint("98765432109876543210"), bigint(-7), bigint(42)};
+        bigint_array array;
+        array.append(values.begin(), values.end());
+        array.push_back(array[3]);
+
+        bool viewsOk = array.size() == 7 && array[1].negative() && array[1].digit_count() == 30 &&
+                       array[1] + array[3] == bigint("-123456789012345678901234567890") + bigint("98765432109876543210") &&
+                       array[0] * array[4] == bigint(-294) && bigint(1) - array[4] == bigint(8) &&
+                       array[0] == array[5] && array[4] < array[2] && array[6] == bigint("98765432109876543210");
+
+        array.sort();
+        std::ostringstream oss;
+        for (size_t i = 0; i < array.size(); i++)
+        {
+            oss << array[i] << " ";
+        }
+        bool sortOk = oss.str() == "-123456789012345678901234567890 -7 0 42 42 98765432109876543210 98765432109876543210 ";
+
+        std::stringstream stream;
+        array.write(stream);
+        bigint_array copy = bigint_array::read(stream);
+        bool serializeOk = copy.size() == array.size() && copy.total_digits() == array.total_digits();
+        for (size_t i = 0; serializeOk && i < copy.size(); i++)
+        {
+            serializeOk = copy[i] == array[i];
+        }
+        testSuccess("bigint_array", viewsOk && sortOk && serializeOk);
+    }
+    catch (const std::exception &e)
+    {
+        testSuccess("bigint_array", false);
+    }
+
+    // Radix sort of bigints against std::sort, serial and parallel
+    {
+        std::mt19937_64 random(12345);
+        std::vector<bigint> values;
+        for (int i = 0; i < 20000; i++)
+        {
+            // many equal lengths and shared prefixes to exercise ties
+            size_t length = 1 + random() % 30;
+            std::string text = random() % 2 ? "-" : "";
+            text += std::to_string(1 + random() % 3);
+            for (size_t k = 1; k < length; k++)
+            {
+                text.push_back(static_cast<char>('0' + (k < 20 ? 5 : random() % 10)));
+            }
+            values.push_back(bigint(text));
+        }
+        std::vector<bigint> expected = values;
+        std::stable_sort(expected.begin(), expected.end());
+        std::vector<bigint> serial = values;
+        sort_bigints(serial);
+        std::vector<bigint> parallel = values;
+        bigint::set_max_threads(4);
+        sort_bigints_parallel(parallel);
+        bigint_array array;
+        array.append(values.begin(), values.end());
+        array.sort(0);
+        bigint::set_max_threads(0);
+
+        bool arrayOk = array.size() == expected.size();
+        for (size_t i = 0; arrayOk && i < expected.size(); i++)
+        {
+            arrayOk = array[i] == expected[i];
+        }
+        testSuccess("Sort bigints", serial == expected && parallel == expected && arrayOk);
+    }
+
+    // Approximate magnitude and logarithms
+    {
+        bigint twoTo100("1267650600228229401496703205376");
+        bigint::approx_magnitude m = (-twoTo100).approx();
+        long double mantissa = static_cast<long double>(m.mantissa) / 9223372036854775808.0L; // in [1, 2)
+        long double value = std::ldexp(mantissa, static_cast<int>(m.exponent + 63));
+        bool approxOk = m.negative && m.exponent >= 36 && m.exponent <= 37 &&
+                        std::fabs(value / std::ldexp(1.0L, 100) - 1) < 1e-15L && bigint(0).approx().mantissa == 0;
+        bool logOk = std::fabs(twoTo100.log2_approx() - 100) < 1e-9 &&
+                     std::fabs(bigint("1" + std::string(50, '0')).log10_approx() - 50) < 1e-12 &&
+                     std::isinf(bigint(0).log10_approx());
+        bool compareOk = bigint("123456789012345678901").compare(bigint("123456789012345678902")) < 0 &&
+                         bigint("-123456789012345678901").compare(bigint("-123456789012345678902")) > 0 &&
+                         bigint("98765432109876543210").compare(bigint("98765432109876543210")) == 0;
+        testSuccess("Approximate magnitude", approxOk && logOk && compareOk);
+    }
+
+    // Fused multiply-add and multiply-subtract against separate operations
+    {
+        std::mt19937_64 random(2024);
+        auto randomBigint = [&random](size_t maxDigits)
+        {
+            std::string text = random() % 2 ? "-" : "";
+            size_t length = 1 + random() % maxDigits;
+            for (size_t i = 0; i < length; i++)
+            {
+                text.push_back(static_cast<char>('0' + random() % 10));
+            }
+            return bigint(text);
+        };
+        bool ok = true;
+        for (int i = 0; i < 300; i++)
+        {
+            bigint acc = randomBigint(i % 3 == 0 ? 5 : 60);
+            bigint a = randomBigint(30);
+            bigint b = randomBigint(30);
+            uint64_t w = random() >> (random() % 64);
+            bigint wordValue(std::to_string(w));
+
+            bigint added = acc;
+            added.addmul(a, b);
+            bigint subtracted = acc;
+            subtracted.submul(a, b);
+            bigint addedWord = acc;
+            addedWord.addmul(a, w);
+            bigint subtractedWord = acc;
+            subtractedWord.submul(a, w);
+            ok &= added == acc + a * b && subtracted == acc - a * b && addedWord == acc + a * wordValue &&
+                  subtractedWord == acc - a * wordValue;
+        }
+        bigint self("-12345678901234567890");
+        bigint expected = self + self * bigint(7);
+        self.addmul(self, bigint(7));
+        ok &= self == expected;
+        bigint cancel("1000000");
+        cancel.submul(bigint(1000), bigint(1000));
+        std::ostringstream oss;
+        oss << cancel;
+        testSuccess("Fused addmul/submul", ok && oss.str() == "0");
+    }
+
+    // Truncating division and modulo, checked through q * b + r == a
+    {
+        std::mt19937_64 random(7);
+        auto randomBigint = [&random](size_t maxDigits)
+        {
+            std::string text = random() % 2 ? "-" : "";
+            size_t length = 1 + random() % maxDigits;
+            for (size_t i = 0; i < length; i++)
+            {
+                text.push_back(static_cast<char>('0' + random() % 10));
+            }
+            return bigint(text);
+        };
+        bool ok = true;
+        for (int i = 0; i < 300; i++)
+        {
+            bigint a = randomBigint(80);
+            bigint b = randomBigint(i % 2 ? 30 : 3);
+            if (b == bigint())
+                continue;
+            bigint q = a / b;
+            bigint r = a % b;
+            bigint absR = r.negative() ? -r : r;
+            bigint absB = b.negative() ? -b : b;
+            ok &= q * b + r == a && absR < absB && (r == bigint() || r.negative() == a.negative());
+        }
+        ok &= bigint(-7) / bigint(2) == bigint(-3) && bigint(-7) % bigint(2) == bigint(-1);
+        bool thrown = false;
+        try
+        {
+            bigint(1) / bigint();
+        }
+        catch (const std::invalid_argument &e)
+        {
+            thrown = std::string(e.what()) == "Division by zero";
+        }
+        testSuccess("Division and modulo", ok && thrown);
+    }
+
+    // Modular exponentiation: Montgomery and division reducers, Straus and Pippenger
+    {
+        bool ok = powmod(bigint(2), bigint(100), bigint(1000000007)) == bigint(976371285) &&
+                  powmod(bigint(3), bigint("100000000000000000001"), bigint("2305843009213693951")) == bigint("2051669278227809764") &&
+                  powmod(bigint(-2), bigint(3), bigint(10)) == bigint(2) && powmod(bigint(5), bigint(), bigint(1)) == bigint();
+
+        std::mt19937_64 random(99);
+        auto randomDigits = [&random](size_t length)
+        {
+            std::string text(1, static_cast<char>('1' + random() % 9));
+            for (size_t i = 1; i < length; i++)
+            {
+                text.push_back(static_cast<char>('0' + random() % 10));
+            }
+            return bigint(text);
+        };
+        bigint odd = randomDigits(40) * bigint(10) + bigint(3);
+        bigint even = randomDigits(40) * bigint(10) + bigint(4);
+        for (size_t count : {size_t(3), size_t(40)})
+        {
+            std::vector<bigint> bases;
+            std::vector<bigint> exps;
+            for (size_t i = 0; i < count; i++)
+            {
+                bases.push_back(randomDigits(45));
+                exps.push_back(i == 1 ? bigint() : randomDigits(1 + random() % 30));
+            }
+            for (const bigint &modulus : {odd, even})
+            {
+                division_reducer reference(modulus);
+                bigint expected(1);
+                for (size_t i = 0; i < count; i++)
+                {
+                    expected = expected * powmod(reference, bases[i], exps[i]) % modulus;
+                }
+                ok &= multi_powmod(bases, exps, modulus) == expected;
+                ok &= multi_powmod(division_reducer(modulus), bases, exps, 1) == expected;
+            }
+        }
+        bigint inverse = mod_inverse(bigint(-17), odd);
+        ok &= reduce_mod(inverse * bigint(-17), odd) == bigint(1);
+        bool thrown = false;
+        try
+        {
+            mod_inverse(bigint(6), bigint(15));
+        }
+        catch (const std::invalid_argument &e)
+        {
+            thrown = true;
+        }
+        testSuccess("Modular exponentiation", ok && thrown);
+    }
+
+    // Primality and factorization: trial division, Pollard rho and ECM
+    {
+        bool primeOk = is_probable_prime(bigint("2305843009213693951")) && !is_probable_prime(bigint("2305843009213693953")) &&
+                       !is_probable_prime(bigint("3215031751")) && is_probable_prime(bigint(2)) && !is_probable_prime(bigint(1)) &&
+                       gcd(bigint("-123456789012345678901234567890"), bigint("987654321098765432109876543210")) == bigint("9000000000900000000090");
+
+        factorization small = factor(bigint(-360));
+        std::vector<bigint> smallExpected = {bigint(2), bigint(2), bigint(2), bigint(3), bigint(3), bigint(5)};
+        factorization mixed = factor(bigint(1000) * bigint(1000003) * bigint(998244353) * bigint(1000000007) * bigint(1000000007));
+        std::vector<bigint> mixedExpected = {bigint(2), bigint(2), bigint(2), bigint(5), bigint(5), bigint(5), bigint(1000003),
+                                             bigint(998244353), bigint(1000000007), bigint(1000000007)};
+
+        // ECM alone: no rho steps
+        factor_options ecmOnly;
+        ecmOnly.rho_iterations = 0;
+        factorization curves = factor(bigint(998244353) * bigint(1000000009), ecmOnly);
+
+        // no effort at all leaves the composite unfactored
+        factor_options none;
+        none.rho_iterations = 0;
+        none.ecm_curves = 0;
+        factorization stuck = factor(bigint(998244353) * bigint(1000000009), none);
+
+        testSuccess("Factorization", primeOk && small.factors == smallExpected && mixed.complete() && mixed.factors == mixedExpected &&
+                                         curves.complete() && curves.factors == std::vector<bigint>{bigint(998244353), bigint(1000000009)} &&
+                                         !stuck.complete() && stuck.unfactored[0] == bigint(998244353) * bigint(1000000009));
+    }
+
+    // Segmented prime sieve: counts, ranges, iterator and threads
+    {
+        bool countOk = prime_sieve(1000000).count(1) == 78498 && prime_sieve(10000000).count(3) == 664579 &&
+                       prime_sieve(1).count() == 0 && prime_sieve(2).count() == 1 && prime_sieve(31).count() == 11;
+        std::vector<uint64_t> small = prime_sieve(50, 10).primes();
+        bool rangeOk = small == std::vector<uint64_t>{11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47};
+
+        // a range past 2^32, spanning several segments, checked against Miller-Rabin
+        prime_sieve far(5000000000ULL + 2000000, 5000000000ULL);
+        std::vector<uint64_t> listed = far.primes(4);
+        std::vector<uint64_t> iterated(far.begin(), far.end());
+        bool farOk = listed == iterated && listed.size() == far.count(2) && !listed.empty();
+        for (size_t i = 0; i < listed.size() && farOk; i += 97)
+        {
+            farOk = is_probable_prime(bigint(static_cast<int64_t>(listed[i])));
+        }
+        testSuccess("Prime sieve", countOk && rangeOk && farOk);
+    }
+
+    // Karatsuba products and short products against division
+    {
+        std::mt19937_64 random(31);
+        auto randomBigint = [&random](size_t length, bool nines)
+        {
+            std::string text = random() % 2 ? "-" : "";
+            text.push_back(static_cast<char>('1' + random() % 9));
+            for (size_t i = 1; i < length; i++)
+            {
+                // runs of nines provoke the carry correction of mul_high
+                text.push_back(nines && random() % 4 != 0 ? '9' : static_cast<char>('0' + random() % 10));
+            }
+            return bigint(text);
+        };
+        bool ok = true;
+        for (int i = 0; i < 200; i++)
+        {
+            bigint a = randomBigint(1 + random() % (i % 3 == 0 ? 400 : 60), i % 2 == 1);
+            bigint b = randomBigint(1 + random() % (i % 5 == 0 ? 400 : 120), i % 2 == 1);
+            bigint product = a * b;
+            size_t n = random() % (a.digit_count() + b.digit_count() + 3);
+            bigint power("1" + std::string(n, '0'));
+            ok &= product / b == a && product % b == bigint() && bigint::mul_low(a, b, n) == product % power &&
+                  bigint::mul_high(a, b, n) == product / power;
+        }
+        bigint nines(std::string(500, '9'));
+        ok &= nines * nines == bigint(std::string(499, '9') + "8" + std::string(499, '0') + "1");
+        testSuccess("Karatsuba and short products", ok);
+    }
+
+    // Unbalanced products: Toom-2.5, Toom-3.5 and piecewise, for growing length ratios
+    {
+        std::mt19937_64 random(57);
+        auto randomBigint = [&random](size_t length)
+        {
+            std::string text = random() % 2 ? "-" : "";
+            text.push_back(static_cast<char>('1' + random() % 9));
+            for (size_t i = 1; i < length; i++)
+            {
+                text.push_back(static_cast<char>('0' + random() % 10));
+            }
+            return bigint(text);
+        };
+        bool ok = true;
+        for (int i = 0; i < 120; i++)
+        {
+            size_t shorter = 48 + random() % 200;
+            bigint a = randomBigint(shorter + shorter * (i % 40) / 10 + random() % 10);
+            bigint b = randomBigint(shorter);
+            bigint product = a * b;
+            ok &= product / b == a && product / a == b && product % a == bigint() && b * a == product;
+        }
+        testSuccess("Unbalanced multiplication", ok);
+    }
+
+    // Comba base case and unrolled fixed-size kernels against the row-wise fused multiply-add
+    {
+        std::mt19937_64 random(3);
+        bool ok = true;
+        for (size_t aLength = 1; aLength <= 70; aLength += (aLength < 20 ? 1 : 7))
+        {
+            for (size_t bLength = 1; bLength <= 70; bLength += (bLength < 20 ? 1 : 7))
+            {
+                std::string aText(1, static_cast<char>('1' + random() % 9));
+                std::string bText(1, static_cast<char>('1' + random() % 9));
+                for (size_t i = 1; i < aLength; i++)
+                    aText.push_back(i % 3 == 0 ? '9' : static_cast<char>('0' + random() % 10));
+                for (size_t i = 1; i < bLength; i++)
+                    bText.push_back(i % 2 == 0 ? '9' : static_cast<char>('0' + random() % 10));
+                bigint a(aText);
+                bigint b(bText);
+                bigint rowWise;
+                rowWise.addmul(a, b);
+                ok &= a * b == rowWise;
+            }
+        }
+        testSuccess("Comba products", ok);
+    }
+
+    // Concurrent counter: many threads adding words that overflow 64 bits
+    try
+    {
+        concurrent_bigint_counter counter(4);
+        const uint64_t big = std::numeric_limits<uint64_t>::max();
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 8; t++)
+        {
+            threads.emplace_back([&counter, big]()
+                                 {
+                for (int i = 0; i < 10000; i++)
+                {
+                    counter.add(big);
+                    counter.increment();
+                } });
+        }
+        counter.add(bigint("-5"));
+        for (std::thread &t : threads)
+        {
+            t.join();
+        }
+
+        bigint expected = bigint("18446744073709551616") * bigint(80000) - bigint(5);
+        testSuccess("Concurrent counter", counter.value() == expected);
+    }
+    catch (const std::exception &e)
+    {
+        testSuccess("Concurrent counter", false);
+    }
 }
 
 /**